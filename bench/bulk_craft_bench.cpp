@@ -0,0 +1,179 @@
+// ------------------------------------------------------------
+// Bulk crafting benchmark – turning 400 iron ore into 200 iron
+// ingots, in a bag that also holds 1000 unrelated stacks: 200 calls
+// to Inventory::craft vs. one craft(resultId, 200). Reports time per
+// batch of 200 and checks both bags end up with the same counts.
+// A second run crafts rolled weapons into a bag with room for only a
+// few: craft(id, n) must give the same items as that many single
+// crafts from an identically seeded factory, and leave the factory's
+// generator in the same state (no rolls wasted on products that don't
+// fit). A third run crafts heavy plates into a bag whose weight cap
+// leaves room for only a quarter of them: the count must match the
+// single crafts, without re‑planning every count down from n.
+// ------------------------------------------------------------
+#include "inventory.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+constexpr int kIngots = 200;
+constexpr int kRounds = 200;
+
+ItemTemplate material(const std::string& id, int weight = 1) {
+    ItemTemplate t;
+    t.id   = ItemIds::intern(id);
+    t.name = id;
+    t.type = ItemType::Material;
+    t.data = MaterialData{weight};
+    return t;
+}
+
+ItemTemplate weapon(const std::string& id) {
+    ItemTemplate t;
+    t.id   = ItemIds::intern(id);
+    t.name = id;
+    t.type = ItemType::Weapon;
+    t.slot = EquipSlot::Weapon;
+    t.data = WeaponData{10, 50, 1};
+    return t;
+}
+
+// (rarity, levelReq, damage) of every stack of `id`, in a fixed order
+std::vector<std::tuple<int, int, int>> rolls(const Inventory& inv, ItemId id) {
+    std::vector<std::tuple<int, int, int>> out;
+    for (const Item& it : inv.getItems()) {
+        if (it.id() != id) continue;
+        auto* w = std::get_if<WeaponData>(&it.data);
+        out.emplace_back(static_cast<int>(it.rarity), it.levelReq, w ? w->damage : 0);
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+void fill(ItemFactory& factory, Inventory& inv, const std::string& id, int units) {
+    while (units > 0) {
+        Item it = factory.create(id).value();
+        it.stackSize = std::min(units, it.maxStack());
+        units -= it.stackSize;
+        inv.addItem(it);
+    }
+}
+
+} // namespace
+
+int main() {
+    ItemFactory    factory(1);
+    CraftingSystem crafting;
+
+    std::vector<ItemTemplate> templates{material("ore"), material("ingot")};
+    for (int i = 0; i < 1000; ++i) templates.push_back(material("junk_" + std::to_string(i)));
+    factory.addTemplates(std::move(templates));
+
+    Recipe ingot;
+    ingot.resultId = ItemIds::find("ingot");
+    ingot.ingredients.emplace_back(ItemIds::find("ore"), 2);
+    crafting.addRecipes({ingot});
+
+    // every craft logs a line; keep it off the terminal (the message is still built)
+    std::streambuf* console = std::cout.rdbuf(nullptr);
+    auto prepare = [&] {
+        Inventory inv(2000, 1 << 30);
+        for (int i = 0; i < 1000; ++i) fill(factory, inv, "junk_" + std::to_string(i), 1);
+        fill(factory, inv, "ore", kIngots * 2);
+        return inv;
+    };
+
+    double loop = 0, bulk = 0;
+    int loopIngots = 0, bulkIngots = 0;
+    for (int round = 0; round < kRounds; ++round) {
+        Inventory a = prepare();
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < kIngots; ++i) a.craft(ingot.resultId, factory, crafting);
+        auto t1 = std::chrono::steady_clock::now();
+        loop += std::chrono::duration<double, std::micro>(t1 - t0).count();
+        loopIngots += a.count(ingot.resultId);
+
+        Inventory b = prepare();
+        t0 = std::chrono::steady_clock::now();
+        b.craft(ingot.resultId, kIngots, factory, crafting);
+        t1 = std::chrono::steady_clock::now();
+        bulk += std::chrono::duration<double, std::micro>(t1 - t0).count();
+        bulkIngots += b.count(ingot.resultId);
+    }
+
+    // rolled products: 8 slots, one taken by the ingots → room for 7 blades
+    factory.addTemplates({weapon("blade")});
+    Recipe blade;
+    blade.resultId = ItemIds::find("blade");
+    blade.ingredients.emplace_back(ItemIds::find("ingot"), 1);
+    crafting.addRecipes({blade});
+
+    ItemFactory bulkFactory(7), loopFactory(7);
+    bulkFactory.addTemplates({material("ingot"), weapon("blade")});
+    loopFactory.addTemplates({material("ingot"), weapon("blade")});
+    Inventory c(8, 1 << 30), d(8, 1 << 30);
+    fill(bulkFactory, c, "ingot", 20);
+    fill(loopFactory, d, "ingot", 20);
+
+    auto made = c.craft(blade.resultId, 20, bulkFactory, crafting);
+    int blades = made ? made.value() : 0;
+    for (int i = 0; i < blades; ++i) d.craft(blade.resultId, loopFactory, crafting);
+    bool sameRolls = blades > 0 && rolls(c, blade.resultId) == rolls(d, blade.resultId);
+    for (int i = 0; i < 16 && sameRolls; ++i) {             // generators still in step?
+        Item x = bulkFactory.create(blade.resultId).value();
+        Item y = loopFactory.create(blade.resultId).value();
+        sameRolls = x.rarity == y.rarity && x.levelReq == y.levelReq;
+    }
+
+    // weight‑tight: a plate (5) from an ingot (1) adds 4 per craft, and the
+    // cap leaves 203 over the starting weight → 50 of 200 fit
+    factory.addTemplates({material("plate", 5)});
+    Recipe plate;
+    plate.resultId = ItemIds::find("plate");
+    plate.ingredients.emplace_back(ItemIds::find("ingot"), 1);
+    crafting.addRecipes({plate});
+    constexpr int kPlates = 200, kPlatesFit = 50;
+    auto prepareTight = [&] {
+        Inventory inv(2000, 1000 + kPlates + 4 * kPlatesFit + 3);
+        for (int i = 0; i < 1000; ++i) fill(factory, inv, "junk_" + std::to_string(i), 1);
+        fill(factory, inv, "ingot", kPlates);
+        return inv;
+    };
+    double tightLoop = 0, tightBulk = 0;
+    int tightLoopPlates = 0, tightBulkPlates = 0;
+    for (int round = 0; round < kRounds; ++round) {
+        Inventory a = prepareTight();
+        auto t0 = std::chrono::steady_clock::now();
+        while (a.craft(plate.resultId, factory, crafting)) {}
+        auto t1 = std::chrono::steady_clock::now();
+        tightLoop += std::chrono::duration<double, std::micro>(t1 - t0).count();
+        tightLoopPlates += a.count(plate.resultId);
+
+        Inventory b = prepareTight();
+        t0 = std::chrono::steady_clock::now();
+        b.craft(plate.resultId, kPlates, factory, crafting);
+        t1 = std::chrono::steady_clock::now();
+        tightBulk += std::chrono::duration<double, std::micro>(t1 - t0).count();
+        tightBulkPlates += b.count(plate.resultId);
+    }
+    bool tightOk = tightBulkPlates == tightLoopPlates && tightBulkPlates == kPlatesFit * kRounds;
+
+    std::cout.rdbuf(console);
+    std::cout.clear();
+    std::printf("%d ingots | %d x craft %8.1f us | craft(id, %d) %6.1f us | %5.1fx | %s\n",
+                kIngots, kIngots, loop / kRounds, kIngots, bulk / kRounds, loop / bulk,
+                loopIngots == bulkIngots ? "same result" : "DIFFERENT");
+    std::printf("rolled blades | craft(id, 20) made %d of 20 | %s\n",
+                blades, sameRolls ? "same rolls as single crafts" : "ROLLS DIFFER");
+    std::printf("weight-tight  | %d plates fit | single crafts %8.1f us | craft(id, %d) %6.1f us | %s\n",
+                tightBulkPlates / kRounds, tightLoop / kRounds, kPlates, tightBulk / kRounds,
+                tightOk ? "same result" : "DIFFERENT");
+    return loopIngots == bulkIngots && sameRolls && tightOk ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+// ------------------------------------------------------------
+// Startup catalog benchmark – loading a production-sized catalog
+// (20k templates, 5k recipes) from templates.json/recipes.json vs.
+// the precompiled catalog.bin. Each side loads into a fresh
+// ItemFactory/CraftingSystem; the results are compared for equality.
+// Then one template and one recipe are deleted from the JSON files and
+// reloaded, which must drop both from the live catalog. Finally the
+// JSON sources are deleted, which must make the binary stale.
+// ------------------------------------------------------------
+#include "catalog_file.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+namespace {
+
+constexpr std::size_t kTemplates = 20000;
+constexpr std::size_t kRecipes   = 5000;
+
+void writeSources(const std::string& templates, const std::string& recipes,
+                  std::size_t nTemplates = kTemplates, std::size_t nRecipes = kRecipes) {
+    static const char* kTypes[] = {"Weapon", "Armor", "Consumable", "Material", "Misc"};
+    static const char* kData[]  = {"{\"damage\":12,\"durability\":80,\"weight\":6}", "{\"defense\":7,\"weight\":9}",
+                                   "{\"healAmount\":25,\"weight\":1}", "{\"weight\":2}", "{\"weight\":1}"};
+    {
+        std::ofstream out(templates);
+        out << "[\n";
+        for (std::size_t i = 0; i < nTemplates; ++i)
+            out << (i ? ",\n" : "") << "{\"id\":\"cat_" << i << "\",\"name\":\"Catalog Item " << i << "\",\"type\":\""
+                << kTypes[i % 5] << "\",\"maxStack\":1,\"data\":" << kData[i % 5] << '}';
+        out << "\n]\n";
+    }
+    std::ofstream out(recipes);
+    out << "[\n";
+    for (std::size_t i = 0; i < nRecipes; ++i)
+        out << (i ? ",\n" : "") << "{\"resultId\":\"cat_" << i * 4 << "\",\"resultCount\":1,\"ingredients\":{\"cat_"
+            << (i * 4 + 1) % kTemplates << "\":2,\"cat_" << (i * 4 + 2) % kTemplates << "\":1,\"cat_"
+            << (i * 4 + 3) % kTemplates << "\":3}}";
+    out << "\n]\n";
+}
+
+template <typename F>
+double millis(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+bool sameCatalog(const ItemFactory& a, const CraftingSystem& ca, const ItemFactory& b, const CraftingSystem& cb) {
+    const auto& ta = a.catalog()->byId;
+    const auto& tb = b.catalog()->byId;
+    if (ta.size() != tb.size()) return false;
+    for (const auto& [id, t] : ta) {
+        auto it = tb.find(id);
+        if (it == tb.end() || !(*it->second == *t)) return false;
+    }
+    const auto& ra = ca.book()->recipes;
+    const auto& rb = cb.book()->recipes;
+    if (ra.size() != rb.size()) return false;
+    for (const auto& [id, r] : ra) {
+        auto it = rb.find(id);
+        if (it == rb.end() || it->second.resultCount != r.resultCount || it->second.ingredients != r.ingredients)
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    const std::string templates = "catalog_bench_templates.json";
+    const std::string recipes   = "catalog_bench_recipes.json";
+    const std::string binary    = "catalog_bench.bin";
+    writeSources(templates, recipes);
+    CatalogFile::compile(templates, recipes, binary);
+
+    ItemFactory    jsonFactory, binFactory;
+    CraftingSystem jsonCrafting, binCrafting;
+    double fromJson = millis([&] {
+        jsonFactory.loadTemplates(templates);
+        jsonCrafting.loadFromFile(recipes);
+    });
+    bool current = CatalogFile::isCurrent(binary, templates, recipes);
+    double fromBinary = millis([&] { CatalogFile::load(binary, templates, recipes, binFactory, binCrafting); });
+
+    std::printf("%zu templates + %zu recipes | JSON %8.2f ms | catalog.bin %8.2f ms (%s) | %5.1fx | results %s\n",
+                kTemplates, kRecipes, fromJson, fromBinary, current ? "current" : "STALE", fromJson / fromBinary,
+                sameCatalog(jsonFactory, jsonCrafting, binFactory, binCrafting) ? "identical" : "DIFFERENT");
+
+    // hot reload with the last template and the last recipe deleted
+    writeSources(templates, recipes, kTemplates - 1, kRecipes - 1);
+    jsonFactory.loadTemplates(templates);
+    jsonCrafting.loadFromFile(recipes);
+    const ItemId goneTemplate = ItemIds::find("cat_" + std::to_string(kTemplates - 1));
+    const ItemId goneRecipe   = ItemIds::find("cat_" + std::to_string((kRecipes - 1) * 4));
+    bool deletedGone = !jsonFactory.find(goneTemplate) && !jsonCrafting.find(goneRecipe) &&
+                       jsonFactory.catalog()->dropOrder.size() == kTemplates - 1 &&
+                       jsonCrafting.book()->recipes.size() == kRecipes - 1;
+    std::printf("reload after deleting an entry | template and recipe %s\n", deletedGone ? "gone" : "STILL LIVE");
+
+    std::remove(templates.c_str());
+    std::remove(recipes.c_str());
+    bool staleWithoutSources = !CatalogFile::isCurrent(binary, templates, recipes);
+    std::printf("sources deleted | catalog.bin %s\n", staleWithoutSources ? "stale" : "STILL CURRENT");
+    std::remove(binary.c_str());
+    return current && deletedGone && staleWithoutSources ? 0 : 1;
+}
@@ -0,0 +1,120 @@
+// ------------------------------------------------------------
+// Crafting planner benchmark – a large layered recipe book
+// (8 tiers × 1000 recipes, 3 ingredients each from the tier below)
+// and a bag holding only tier-0 raw materials. Times the first
+// query (compile + memoised order) and repeated plan() and
+// maxCraftable() queries on top-tier targets. Then a single recipe
+// chain 500k deep (and one closed into a cycle) must plan without
+// overflowing the call stack.
+// ------------------------------------------------------------
+#include "craft_planner.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int kTiers   = 8;
+constexpr int kPerTier = 1000;
+constexpr int kRaw     = 50;
+
+std::string name(int tier, int i) { return "t" + std::to_string(tier) + "_" + std::to_string(i); }
+
+template <typename F>
+double micros(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(stop - start).count();
+}
+
+// chain_0 ← chain_1 ← … ← chain_{depth}, the last one raw; `closed`
+// makes the bottom recipe need the top item as well
+bool deepChain(int depth, bool closed) {
+    const std::string tag = closed ? "loop_" : "chain_";
+    CraftingSystem crafting;
+    std::vector<Recipe> recipes;
+    recipes.reserve(depth);
+    for (int i = 0; i < depth; ++i) {
+        Recipe r;
+        r.resultId = ItemIds::intern(tag + std::to_string(i));
+        r.ingredients.emplace_back(ItemIds::intern(tag + std::to_string(i + 1)), 1);
+        if (closed && i == depth - 1) r.ingredients.emplace_back(ItemIds::find(tag + "0"), 1);
+        recipes.push_back(std::move(r));
+    }
+    crafting.addRecipes(std::move(recipes));
+
+    Inventory inv;
+    CraftPlanner planner(crafting);
+    auto plan = planner.plan(inv, ItemIds::find(tag + "0"));
+    bool ok = closed ? !plan : plan && plan.value().lines.size() == static_cast<std::size_t>(depth) + 1 &&
+                                   plan.value().shortfall.size() == 1;
+    std::printf("%s chain %d deep | %s\n", closed ? "cyclic" : "plain ", depth,
+                ok ? (closed ? "cycle reported" : "planned") : "WRONG RESULT");
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    ItemFactory    factory(1);
+    CraftingSystem crafting;
+
+    std::vector<ItemTemplate> templates;
+    for (int i = 0; i < kRaw; ++i) {
+        ItemTemplate t;
+        t.id   = ItemIds::intern(name(0, i));
+        t.name = name(0, i);
+        t.type = ItemType::Material;
+        t.data = MaterialData{1};
+        templates.push_back(t);
+    }
+    factory.addTemplates(std::move(templates));
+
+    std::vector<Recipe> recipes;
+    for (int tier = 1; tier <= kTiers; ++tier) {
+        int below = tier == 1 ? kRaw : kPerTier;
+        for (int i = 0; i < kPerTier; ++i) {
+            Recipe r;
+            r.resultId    = ItemIds::intern(name(tier, i));
+            r.resultCount = 1 + i % 2;
+            for (int k = 0; k < 3; ++k)
+                r.ingredients.emplace_back(ItemIds::intern(name(tier - 1, (i * 7 + k * 13) % below)), 1 + k);
+            recipes.push_back(std::move(r));
+        }
+    }
+    crafting.addRecipes(std::move(recipes));
+
+    Inventory inv(kRaw, 1 << 30);
+    for (int i = 0; i < kRaw; ++i) {
+        Item it = factory.create(name(0, i)).value();
+        it.stackSize = 20;                         // maxStack for materials
+        inv.addItem(it);
+    }
+
+    CraftPlanner planner(crafting);
+    const ItemId first = ItemIds::find(name(kTiers, 0));
+    std::size_t lines = 0;
+    double cold = micros([&] { lines = planner.plan(inv, first).value().lines.size(); });
+
+    constexpr int kQueries = 2000;
+    volatile int sink = 0;
+    double plans = micros([&] {
+        for (int q = 0; q < kQueries; ++q)
+            sink = sink + static_cast<int>(planner.plan(inv, ItemIds::find(name(kTiers, q % 64)), 3).value().lines.size());
+    });
+    double maxes = micros([&] {
+        for (int q = 0; q < kQueries; ++q)
+            sink = sink + planner.maxCraftable(inv, ItemIds::find(name(kTiers, q % 64))).value();
+    });
+
+    std::printf("%d recipes | first plan (compile) %8.1f us, %zu lines | plan %6.2f us/query | maxCraftable %6.2f us/query\n",
+                kTiers * kPerTier, cold, lines, plans / kQueries, maxes / kQueries);
+
+    constexpr int kDepth = 500000;
+    bool deep = deepChain(kDepth, false);
+    deep = deepChain(kDepth, true) && deep;
+    return deep ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+// ------------------------------------------------------------
+// "Craftable now" benchmark – a crafting UI that refreshes the list
+// after every inventory change. 2000 recipes over 400 materials;
+// each step adds or removes one material, then the list is rebuilt
+// by scanning every recipe (get + count per ingredient, the old way)
+// or read from Inventory::craftable() (reverse index, incremental).
+// ------------------------------------------------------------
+#include "inventory.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int kMaterials = 400;
+constexpr int kRecipes   = 2000;
+constexpr int kSteps     = 20000;
+
+std::string material(int i) { return "mat_" + std::to_string(i); }
+
+template <typename F>
+double micros(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(stop - start).count();
+}
+
+// same random add/remove sequence for both runs; `refresh` runs after each
+template <typename F>
+double simulate(ItemFactory& factory, Inventory& inv, F&& refresh) {
+    std::mt19937 rng(3);
+    return micros([&] {
+        for (int step = 0; step < kSteps; ++step) {
+            std::string id = material(static_cast<int>(rng() % kMaterials));
+            if (rng() % 2) {
+                Item it = factory.create(id).value();
+                it.stackSize = 1 + static_cast<int>(rng() % 5);
+                inv.addItem(it);
+            } else {
+                inv.removeItem(id, 1 + static_cast<int>(rng() % 5));
+            }
+            refresh();
+        }
+    });
+}
+
+} // namespace
+
+int main() {
+    ItemFactory    factory(1);
+    CraftingSystem crafting;
+
+    std::vector<ItemTemplate> templates;
+    for (int i = 0; i < kMaterials; ++i) {
+        ItemTemplate t;
+        t.id   = ItemIds::intern(material(i));
+        t.name = material(i);
+        t.type = ItemType::Material;
+        t.data = MaterialData{1};
+        templates.push_back(t);
+    }
+    factory.addTemplates(std::move(templates));
+
+    std::mt19937 rng(9);
+    std::vector<Recipe> recipes;
+    for (int r = 0; r < kRecipes; ++r) {
+        Recipe rec;
+        rec.resultId = ItemIds::intern("product_" + std::to_string(r));
+        for (int k = 0; k < 3; ++k)
+            rec.ingredients.emplace_back(ItemIds::intern(material(static_cast<int>(rng() % kMaterials))),
+                                         1 + static_cast<int>(rng() % 4));
+        recipes.push_back(std::move(rec));
+    }
+    crafting.addRecipes(std::move(recipes));
+
+    std::vector<ItemId> resultIds;
+    for (const auto& [id, rec] : crafting.book()->recipes) resultIds.push_back(id);
+
+    std::vector<ItemId> list;
+    std::size_t before = 0, after = 0;
+    Inventory scanned(kMaterials * 2, 1 << 30);
+    double scan = simulate(factory, scanned, [&] {
+        list.clear();
+        for (ItemId id : resultIds) {
+            const Recipe* rec = crafting.find(id);
+            bool ok = true;
+            for (const auto& [ing, qty] : rec->ingredients) ok = ok && scanned.count(ing) >= qty;
+            if (ok) list.push_back(id);
+        }
+        before += list.size();
+    });
+
+    Inventory tracked(kMaterials * 2, 1 << 30);
+    tracked.trackCraftable(crafting);
+    double incremental = simulate(factory, tracked, [&] { after += tracked.craftable().size(); });
+
+    std::printf("%d recipes, %d changes | full scan %8.2f us/change | incremental %6.2f us/change | %s\n",
+                kRecipes, kSteps, scan / kSteps, incremental / kSteps,
+                before == after ? "same lists" : "DIFFERENT");
+    return 0;
+}
@@ -0,0 +1,92 @@
+// ------------------------------------------------------------
+// Item description benchmark – rendering a full inventory screen
+// with getDescription() per row vs. appendDescriptions() into one
+// reused buffer. Counts heap allocations per frame.
+// ------------------------------------------------------------
+#include "item.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::size_t gAllocs = 0;
+
+} // namespace
+
+void* operator new(std::size_t n) {
+    ++gAllocs;
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+std::vector<Item> makeScreen(std::size_t rows) {
+    struct Def { const char* id; const char* name; ItemType type; int maxStack; ItemPayload data; };
+    const Def defs[] = {
+        {"iron_ore",        "Iron Ore",               ItemType::Material,   20, MaterialData{2}},
+        {"health_potion",   "Minor Healing Potion",   ItemType::Consumable, 20, ConsumableData{25, 1}},
+        {"steel_longsword", "Steel Longsword",        ItemType::Weapon,      1, WeaponData{18, 150, 6}},
+        {"iron_helmet",     "Iron Helmet",            ItemType::Armor,       1, ArmorData{6, 4}},
+        {"amulet_magic",    "Amulet of Arcane Focus", ItemType::Misc,        1, MiscData{1}},
+    };
+    std::vector<Item> out;
+    for (std::size_t i = 0; i < rows; ++i) {
+        const Def& d = defs[i % std::size(defs)];
+        ItemTemplate t;
+        t.id       = ItemIds::intern(d.id);
+        t.name     = d.name;
+        t.type     = d.type;
+        t.maxStack = d.maxStack;
+        t.data     = d.data;
+        Item it(ItemTemplates::intern(std::move(t)), static_cast<int>(i % 20) + 1);
+        it.rarity = static_cast<Rarity>(i % kRarityCount);
+        out.push_back(it);
+    }
+    return out;
+}
+
+template <typename F>
+void measure(const char* label, std::size_t rows, int frames, F&& frame) {
+    frame();                                   // warm‑up: let reused buffers grow
+    gAllocs = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; ++i) frame();
+    auto stop = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(stop - start).count() / frames;
+    std::printf("%-20s | %5zu rows | %10.1f ns/frame | %6.1f allocs/frame\n",
+                label, rows, ns, static_cast<double>(gAllocs) / frames);
+}
+
+} // namespace
+
+int main() {
+    constexpr int kFrames = 2000;
+    for (std::size_t rows : {std::size_t{30}, std::size_t{300}}) {
+        const auto items = makeScreen(rows);
+        volatile std::size_t sink = 0;
+
+        measure("getDescription", rows, kFrames, [&] {
+            std::string screen;
+            std::size_t i = 0;
+            for (const Item& it : items)
+                screen += std::to_string(++i) + ") " + it.getDescription() + "\n";
+            sink = sink + screen.size();
+        });
+
+        std::string buffer;
+        measure("appendDescriptions", rows, kFrames, [&] {
+            buffer.clear();
+            appendDescriptions(buffer, items);
+            sink = sink + buffer.size();
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,169 @@
+// ------------------------------------------------------------
+// Inventory hot-path benchmark – add/remove/count/canAdd cost at
+// different inventory sizes (30 = backpack, 1k = bank, 50k = stash),
+// separate calls vs. one applyBatch for a 10-op transaction, and an
+// indexed query() vs. copying + sorting getItems() every frame, and a
+// full serialize() vs. serializeDelta() after one stack changed.
+// ------------------------------------------------------------
+#include "inventory.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+Item makeItem(const std::string& id, int stackSize, int maxStack,
+              ItemType type = ItemType::Material, ItemPayload data = MaterialData{1}) {
+    ItemTemplate t;
+    t.id       = ItemIds::intern(id);
+    t.name     = id;
+    t.type     = type;
+    t.maxStack = maxStack;
+    t.data     = data;
+    return Item(ItemTemplates::intern(std::move(t)), stackSize);
+}
+
+template <typename F>
+double nsPerOp(int iterations, F&& op) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) op(i);
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() / iterations;
+}
+
+void run(std::size_t slots) {
+    constexpr int kIterations = 20000;
+    Inventory inv(slots + 8, 1 << 30);
+
+    // fill with unrelated full stacks so the hot id sits behind all of them
+    for (std::size_t i = 0; i < slots; ++i)
+        inv.addItem(makeItem("filler_" + std::to_string(i), 1, 1));
+    inv.addItem(makeItem("iron_ore", 7, 20));
+
+    const ItemId oreId = ItemIds::find("iron_ore");
+    const Item ore = makeItem("iron_ore", 1, 20);
+    const Item bulk = makeItem("iron_ore", 25, 20);
+    volatile long sink = 0;
+
+    double add = nsPerOp(kIterations, [&](int) {
+        inv.addItem(ore);
+        inv.removeItem(oreId, 1);
+    });
+    double cnt = nsPerOp(kIterations, [&](int) { sink = sink + inv.count(oreId); });
+    double can = nsPerOp(kIterations, [&](int) { sink = sink + static_cast<bool>(inv.canAdd(bulk)); });
+
+    std::printf("%8zu slots | add+remove %10.1f ns | count %10.1f ns | canAdd %10.1f ns\n",
+                slots, add, cnt, can);
+}
+
+// a quest reward / trade sized transaction: 5 adds + 5 removes
+void runBatch() {
+    constexpr int kIterations = 500000;
+    constexpr int kIds = 5;
+    Inventory inv(64, 1 << 30);
+
+    std::vector<ItemId> ids;
+    std::vector<Item> loot;
+    for (int i = 0; i < kIds; ++i) {
+        loot.push_back(makeItem("reward_" + std::to_string(i), 3, 20));
+        ids.push_back(loot.back().id());
+        inv.addItem(makeItem("reward_" + std::to_string(i), 10, 20));
+    }
+
+    std::vector<InventoryOp> ops;
+    for (int i = 0; i < kIds; ++i) ops.push_back(InventoryOp::add(loot[i]));
+    for (int i = 0; i < kIds; ++i) ops.push_back(InventoryOp::remove(ids[i], 3));
+
+    double separate = nsPerOp(kIterations, [&](int) {
+        for (int i = 0; i < kIds; ++i) inv.addItem(loot[i]);
+        for (int i = 0; i < kIds; ++i) inv.removeItem(ids[i], 3);
+    }) / static_cast<double>(ops.size());
+    double batched = nsPerOp(kIterations, [&](int) { inv.applyBatch(ops); })
+                     / static_cast<double>(ops.size());
+
+    std::printf("batch of %zu ops  | separate %8.1f ns/op | applyBatch %8.1f ns/op\n",
+                ops.size(), separate, batched);
+}
+
+// "top 20 weapons by damage usable at level 30" out of a mixed stash
+void runQuery(std::size_t slots) {
+    constexpr int kIterations = 2000;
+    Inventory inv(slots + 8, 1 << 30);
+    for (std::size_t i = 0; i < slots; ++i) {
+        Item it = i % 4 == 0
+            ? makeItem("stash_" + std::to_string(i), 1, 1, ItemType::Weapon,
+                       WeaponData{static_cast<int>((i * 37) % 500), -1, 1})
+            : makeItem("stash_" + std::to_string(i), 1, 1);
+        it.levelReq = static_cast<std::uint16_t>(i % 60);
+        inv.addItem(it);
+    }
+
+    ItemQuery q;
+    q.type        = ItemType::Weapon;
+    q.maxLevelReq = 30;
+    q.sortBy      = ItemSortKey::Damage;
+    q.descending  = true;
+    q.limit       = 20;
+
+    std::vector<SlotHandle> out;
+    volatile std::size_t sink = 0;
+    double indexed = nsPerOp(kIterations, [&](int) { inv.query(q, out); sink = sink + out.size(); });
+
+    double copied = nsPerOp(kIterations, [&](int) {
+        std::vector<Item> items;
+        for (const Item& it : inv.getItems())
+            if (it.type() == ItemType::Weapon && it.levelReq <= 30) items.push_back(it);
+        auto damage = [](const Item& it) { return std::get<WeaponData>(it.data).damage; };
+        std::sort(items.begin(), items.end(),
+                  [&](const Item& a, const Item& b) { return damage(a) > damage(b); });
+        if (items.size() > 20) items.resize(20);
+        sink = sink + items.size();
+    });
+
+    std::printf("%8zu slots | top-20 query %10.1f ns | copy+sort %12.1f ns\n",
+                slots, indexed, copied);
+}
+
+// autosave: one stack changed since the last checkpoint
+void runSave(std::size_t slots) {
+    constexpr int kIterations = 200;
+    Inventory inv(slots + 8, 1 << 30);
+    for (std::size_t i = 0; i < slots; ++i)
+        inv.addItem(makeItem("save_" + std::to_string(i), 5, 20));
+    inv.checkpoint();
+
+    const ItemId hot = ItemIds::find("save_0");
+    std::size_t fullBytes = 0, deltaBytes = 0;
+    double full = nsPerOp(kIterations, [&](int) {
+        inv.removeItem(hot, 1);
+        inv.addItem(makeItem("save_0", 1, 20));
+        fullBytes = inv.serialize().size();
+        inv.checkpoint();
+    });
+    double delta = nsPerOp(kIterations, [&](int) {
+        inv.removeItem(hot, 1);
+        inv.addItem(makeItem("save_0", 1, 20));
+        deltaBytes = inv.serializeDelta().size();
+        inv.checkpoint();
+    });
+
+    std::printf("%8zu slots | full save %12.1f ns (%7zu B) | delta %9.1f ns (%4zu B)\n",
+                slots, full, fullBytes, delta, deltaBytes);
+}
+
+} // namespace
+
+int main() {
+    for (std::size_t slots : {std::size_t{30}, std::size_t{1000}, std::size_t{50000}})
+        run(slots);
+    runBatch();
+    for (std::size_t slots : {std::size_t{30}, std::size_t{1000}, std::size_t{50000}})
+        runQuery(slots);
+    for (std::size_t slots : {std::size_t{30}, std::size_t{1000}, std::size_t{5000}})
+        runSave(slots);
+    return 0;
+}
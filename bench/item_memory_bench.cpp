@@ -0,0 +1,144 @@
+// ------------------------------------------------------------
+// Item memory benchmark – flyweight Item (template pointer + rolled
+// fields) vs. the old layout that copied id/name/type/maxStack/slot
+// into every stack and built "Rare Iron Sword" per item. Also reloads
+// the templates 1000 times, flipping between two edits, and checks the
+// template catalog only grew by the two distinct versions per id.
+// ------------------------------------------------------------
+#include "item.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::size_t gHeapBytes = 0;
+bool gCounting = false;
+
+} // namespace
+
+void* operator new(std::size_t n) {
+    if (gCounting) gHeapBytes += n;
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+// the pre‑flyweight Item, field for field
+struct LegacyItem {
+    ItemId      id;
+    std::string name;
+    ItemType    type{ItemType::Misc};
+    int         rarity{0};
+    int         levelReq{1};
+    int         stackSize{1};
+    int         maxStack{1};
+    EquipSlot   slot{EquipSlot::None};
+    ItemPayload data;
+};
+
+std::vector<const ItemTemplate*> makeTemplates() {
+    struct Def { const char* id; const char* name; ItemType type; int maxStack; ItemPayload data; };
+    const Def defs[] = {
+        {"iron_ore",        "Iron Ore",               ItemType::Material,   20, MaterialData{2}},
+        {"leather",         "Leather",                ItemType::Material,   20, MaterialData{1}},
+        {"health_potion",   "Minor Healing Potion",   ItemType::Consumable, 20, ConsumableData{25, 1}},
+        {"steel_longsword", "Steel Longsword",        ItemType::Weapon,      1, WeaponData{18, 150, 6}},
+        {"iron_helmet",     "Iron Helmet",            ItemType::Armor,       1, ArmorData{6, 4}},
+        {"amulet_magic",    "Amulet of Arcane Focus", ItemType::Misc,        1, MiscData{1}},
+    };
+    std::vector<const ItemTemplate*> out;
+    for (const Def& d : defs) {
+        ItemTemplate t;
+        t.id       = ItemIds::intern(d.id);
+        t.name     = d.name;
+        t.type     = d.type;
+        t.maxStack = d.maxStack;
+        t.data     = d.data;
+        out.push_back(&ItemTemplates::intern(std::move(t)));
+    }
+    return out;
+}
+
+// same weights as ItemFactory
+Rarity rollRarity(std::mt19937& rng) {
+    int roll = std::uniform_int_distribution<int>(1, 100)(rng);
+    if (roll <= 55) return Rarity::Common;
+    if (roll <= 80) return Rarity::Uncommon;
+    if (roll <= 92) return Rarity::Rare;
+    if (roll <= 98) return Rarity::Epic;
+    return Rarity::Legendary;
+}
+
+template <typename Make>
+void measure(const char* label, std::size_t count, std::size_t itemSize, Make&& make) {
+    std::mt19937 rng(42);
+    std::vector<decltype(make(rng, 0))> items;
+    items.reserve(count);
+
+    gHeapBytes = 0;
+    gCounting = true;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < count; ++i) items.push_back(make(rng, i));
+    auto stop = std::chrono::steady_clock::now();
+    gCounting = false;
+
+    double ns = std::chrono::duration<double, std::nano>(stop - start).count() / count;
+    double perItem = static_cast<double>(gHeapBytes) / count;
+    double totalMb = (static_cast<double>(itemSize) * count + gHeapBytes) / (1024.0 * 1024.0);
+    std::printf("%-10s | sizeof %3zu B | heap %6.1f B/item | %8.1f MB per %zu items | %6.1f ns/item\n",
+                label, itemSize, perItem, totalMb, count, ns);
+}
+
+} // namespace
+
+int main() {
+    constexpr std::size_t kItems = 1000000;
+    const auto templates = makeTemplates();
+
+    measure("legacy", kItems, sizeof(LegacyItem), [&](std::mt19937& rng, std::size_t i) {
+        const ItemTemplate& t = *templates[i % templates.size()];
+        LegacyItem it;
+        it.id       = t.id;
+        it.name     = t.name;
+        it.type     = t.type;
+        it.maxStack = t.maxStack;
+        it.slot     = t.slot;
+        it.data     = t.data;
+        Rarity r    = rollRarity(rng);
+        it.rarity   = static_cast<int>(r);
+        std::string_view prefix = rarityPrefix(r);
+        if (!prefix.empty()) it.name = std::string(prefix) + " " + it.name;
+        return it;
+    });
+
+    measure("flyweight", kItems, sizeof(Item), [&](std::mt19937& rng, std::size_t i) {
+        Item it(*templates[i % templates.size()]);
+        it.rarity = rollRarity(rng);
+        return it;
+    });
+
+    // reload churn – templates are immortal, so only distinct edits may cost memory
+    constexpr int kReloads = 1000;
+    const std::size_t before = ItemTemplates::versionCount();
+    for (int r = 0; r < kReloads; ++r) {
+        for (const ItemTemplate* t : templates) {
+            ItemTemplate edited = *t;
+            if (r % 2) edited.name += " (tuned)";
+            ItemTemplates::intern(std::move(edited));
+        }
+    }
+    const std::size_t grown = ItemTemplates::versionCount() - before;
+    const bool bounded = grown == templates.size();         // one new version per id
+    std::printf("reloads    | %d reloads of %zu templates | %zu new versions | %s\n",
+                kReloads, templates.size(), grown, bounded ? "bounded" : "GROWS PER RELOAD");
+    return bounded ? 0 : 1;
+}
@@ -0,0 +1,224 @@
+// ------------------------------------------------------------
+// Loot generation benchmark – drops/sec for raid-sized loot:
+// the old createRandomItem (linear rarity table rebuilt per roll,
+// std::next over the template map) vs. the alias-table version,
+// one call per drop and via createBatch into a reused buffer;
+// plus rolls/sec through a four-level nested LootTables chain, and
+// createBatch on 1/2/4 threads, one ItemFactory::Stream per thread.
+// ------------------------------------------------------------
+#include "item_factory.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// the pre‑alias ItemFactory roll, step for step
+class LegacyFactory {
+public:
+    explicit LegacyFactory(const std::vector<const ItemTemplate*>& templates) : rng_(7) {
+        for (const ItemTemplate* t : templates) templates_[t->id] = t;
+    }
+
+    Item createRandomItem(int playerLevel) {
+        std::uniform_int_distribution<std::size_t> dist(0, templates_.size() - 1);
+        auto it = std::next(templates_.begin(), dist(rng_));
+        Item result(*it->second);
+        result.levelReq = static_cast<std::uint16_t>(std::max(1, playerLevel - 2 + randInt(-1, 2)));
+        result.rarity = randomRarity();
+        float rarityMul = 1.0f + static_cast<float>(static_cast<int>(result.rarity)) * 0.2f;
+        std::visit([&](auto& data) {
+            using T = std::decay_t<decltype(data)>;
+            if constexpr (std::is_same_v<T, WeaponData>) {
+                data.damage = static_cast<int>(data.damage * rarityMul);
+                if (data.durability > 0) data.durability = static_cast<int>(data.durability * rarityMul);
+            } else if constexpr (std::is_same_v<T, ArmorData>) {
+                data.defense = static_cast<int>(data.defense * rarityMul);
+            } else if constexpr (std::is_same_v<T, ConsumableData>) {
+                data.healAmount = static_cast<int>(data.healAmount * rarityMul);
+            }
+        }, result.data);
+        return result;
+    }
+
+private:
+    std::mt19937 rng_;
+    std::unordered_map<ItemId, const ItemTemplate*> templates_;
+
+    int randInt(int a, int b) { std::uniform_int_distribution<int> d(a, b); return d(rng_); }
+
+    Rarity randomRarity() {
+        std::array<std::pair<Rarity, int>, 5> table{{
+            {Rarity::Common, 55}, {Rarity::Uncommon, 25}, {Rarity::Rare, 12},
+            {Rarity::Epic, 6}, {Rarity::Legendary, 2}
+        }};
+        int total = 0; for (auto& p : table) total += p.second;
+        int roll = randInt(1, total);
+        int acc = 0;
+        for (auto& p : table) {
+            acc += p.second;
+            if (roll <= acc) return p.first;
+        }
+        return Rarity::Common;
+    }
+};
+
+// writes `count` templates to a scratch file and loads them
+std::vector<const ItemTemplate*> loadCatalog(ItemFactory& factory, std::size_t count) {
+    const std::string path = "loot_bench_templates.json";
+    {
+        std::ofstream out(path);
+        out << "[\n";
+        for (std::size_t i = 0; i < count; ++i) {
+            bool weapon = i % 3 == 0;
+            out << (i ? ",\n" : "") << "{\"id\":\"loot_" << count << '_' << i << "\",\"name\":\"Loot " << i
+                << "\",\"type\":\"" << (weapon ? "Weapon" : "Material") << "\",\"maxStack\":1,\"data\":"
+                << (weapon ? "{\"damage\":10,\"durability\":100,\"weight\":5}" : "{\"weight\":1}") << '}';
+        }
+        out << "\n]\n";
+    }
+    factory.loadTemplates(path);
+    std::remove(path.c_str());
+
+    std::vector<const ItemTemplate*> out;
+    for (std::size_t i = 0; i < count; ++i)
+        out.push_back(ItemTemplates::find(ItemIds::find("loot_" + std::to_string(count) + "_" + std::to_string(i))));
+    return out;
+}
+
+template <typename F>
+double dropsPerSec(std::size_t drops, F&& generate) {
+    auto start = std::chrono::steady_clock::now();
+    generate(drops);
+    auto stop = std::chrono::steady_clock::now();
+    return static_cast<double>(drops) / std::chrono::duration<double>(stop - start).count();
+}
+
+void run(std::size_t templates) {
+    constexpr std::size_t kDrops = 2000000;
+    constexpr std::size_t kPerTick = 5000;
+    ItemFactory factory;
+    const auto catalog = loadCatalog(factory, templates);
+    LegacyFactory legacy(catalog);
+    volatile std::uint32_t sink = 0;
+
+    double before = dropsPerSec(kDrops, [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) sink = sink + legacy.createRandomItem(30).id().value;
+    });
+    double single = dropsPerSec(kDrops, [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) sink = sink + factory.createRandomItem(30).value().id().value;
+    });
+    std::vector<Item> buffer;
+    double batched = dropsPerSec(kDrops, [&](std::size_t n) {
+        for (std::size_t done = 0; done < n; done += kPerTick) {
+            buffer.clear();
+            factory.createBatch(kPerTick, 30, buffer);
+            sink = sink + buffer.back().id().value;
+        }
+    });
+
+    std::printf("%6zu templates | before %6.2f M drops/s | createRandomItem %6.2f M/s | createBatch(%zu) %6.2f M/s\n",
+                templates, before / 1e6, single / 1e6, kPerTick, batched / 1e6);
+}
+
+// boss -> tier -> family -> items, each level 8 weighted entries
+void runTables() {
+    constexpr int kRolls = 1000000;
+    ItemFactory factory;
+    loadCatalog(factory, 64);
+
+    std::string src = "[{\"id\":\"boss\",\"rolls\":3,\"guaranteed\":[{\"table\":\"tier0\"}],\"entries\":[";
+    for (int t = 0; t < 8; ++t) src += std::string(t ? "," : "") + "{\"table\":\"tier" + std::to_string(t) + "\",\"weight\":" + std::to_string(8 - t) + "}";
+    src += "]}";
+    for (int t = 0; t < 8; ++t) {
+        src += ",{\"id\":\"tier" + std::to_string(t) + "\",\"entries\":[";
+        for (int f = 0; f < 8; ++f) src += std::string(f ? "," : "") + "{\"table\":\"family" + std::to_string(f) + "\",\"weight\":" + std::to_string(1 + f) + "}";
+        src += "]}";
+    }
+    for (int f = 0; f < 8; ++f) {
+        src += ",{\"id\":\"family" + std::to_string(f) + "\",\"entries\":[";
+        for (int i = 0; i < 8; ++i)
+            src += std::string(i ? "," : "") + "{\"item\":\"loot_64_" + std::to_string(f * 8 + i) +
+                   "\",\"weight\":" + std::to_string(10 + i) + ",\"min\":1,\"max\":3}";
+        src += "]}";
+    }
+    src += "]";
+
+    LootTables tables;
+    tables.load(json::parse(src));
+    const LootTables::TableId boss = tables.find("boss");
+
+    std::mt19937 rng(11);
+    std::vector<LootDrop> drops;
+    volatile std::uint32_t sink = 0;
+    double raw = dropsPerSec(kRolls, [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            drops.clear();
+            tables.roll(boss, rng, drops);
+            sink = sink + drops.back().item.value;
+        }
+    });
+    std::vector<Item> items;
+    double rolled = dropsPerSec(kRolls, [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            items.clear();
+            factory.rollLoot(tables, boss, 30, items);
+            sink = sink + items.back().id().value;
+        }
+    });
+    std::printf("loot table (4 levels, 4 drops/roll) | LootTables::roll %6.2f M rolls/s | rollLoot %6.2f M rolls/s\n",
+                raw / 1e6, rolled / 1e6);
+}
+
+// same master seed, one stream per worker; replaying the run must
+// reproduce every stream's checksum
+void runParallel(unsigned threads) {
+    constexpr std::size_t kDrops = 2000000;
+    ItemFactory factory(2024);
+    loadCatalog(factory, 22);
+
+    std::vector<std::uint64_t> sums(threads);
+    auto work = [&] {
+        std::vector<std::thread> pool;
+        for (unsigned t = 0; t < threads; ++t) {
+            pool.emplace_back([&, t] {
+                ItemFactory::Stream stream = factory.stream(t + 1);
+                std::vector<Item> buffer;
+                std::uint64_t sum = 0;
+                for (std::size_t done = 0; done < kDrops / threads; done += 1000) {
+                    buffer.clear();
+                    stream.createBatch(1000, 30, buffer);
+                    for (const Item& it : buffer) sum = sum * 31 + it.id().value + static_cast<std::uint64_t>(it.rarity);
+                }
+                sums[t] = sum;
+            });
+        }
+        for (auto& th : pool) th.join();
+    };
+    double rate = dropsPerSec(kDrops, [&](std::size_t) { work(); });
+    const auto first = sums;
+    work();
+    std::printf("%u thread(s) | %6.2f M drops/s total | stream 1 checksum %016llx | replay %s\n",
+                threads, rate / 1e6, static_cast<unsigned long long>(first[0]),
+                first == sums ? "identical" : "DIFFERENT");
+}
+
+} // namespace
+
+int main() {
+    for (std::size_t templates : {std::size_t{22}, std::size_t{2000}})
+        run(templates);
+    runTables();
+    for (unsigned threads : {1u, 2u, 4u})
+        runParallel(threads);
+    return 0;
+}
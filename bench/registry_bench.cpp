@@ -0,0 +1,80 @@
+// ------------------------------------------------------------
+// InventoryRegistry throughput – add/remove on random players from
+// 1..N worker threads (N = cores, or argv[1]), sharded registry vs.
+// a single shard.
+// ------------------------------------------------------------
+#include "inventory_registry.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr std::uint64_t kPlayers = 10000;
+constexpr int kOpsPerThread = 200000;
+
+Item makeOre() {
+    ItemTemplate t;
+    t.id       = ItemIds::intern("iron_ore");
+    t.name     = "Iron Ore";
+    t.type     = ItemType::Material;
+    t.maxStack = 20;
+    t.data     = MaterialData{2};
+    return Item(ItemTemplates::intern(std::move(t)));
+}
+
+double opsPerSecond(InventoryRegistry& reg, unsigned threads) {
+    const Item ore = makeOre();
+    std::atomic<bool> go{false};
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t] {
+            std::mt19937_64 rng(t + 1);
+            std::uniform_int_distribution<std::uint64_t> pick(0, kPlayers - 1);
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            for (int i = 0; i < kOpsPerThread; ++i) {
+                reg.with(pick(rng), [&](Inventory& inv) {
+                    auto r = inv.addItem(ore);
+                    if (!r) return r;
+                    return inv.removeItem(ore.id(), 1);
+                });
+            }
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& th : pool) th.join();
+    auto stop = std::chrono::steady_clock::now();
+    double secs = std::chrono::duration<double>(stop - start).count();
+    return static_cast<double>(threads) * kOpsPerThread / secs;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    if (argc > 1) maxThreads = std::max(1, std::atoi(argv[1]));
+    InventoryRegistry sharded(64);
+    InventoryRegistry single(1);
+    for (std::uint64_t p = 0; p < kPlayers; ++p) {
+        sharded.create(p);
+        single.create(p);
+    }
+
+    // 1, 2, 4, … up to N, then N itself if it isn't a power of two
+    std::vector<unsigned> counts;
+    for (unsigned t = 1; t <= maxThreads; t *= 2) counts.push_back(t);
+    if (counts.back() != maxThreads) counts.push_back(maxThreads);
+
+    std::printf("threads | 64 shards (ops/s) | 1 shard (ops/s)\n");
+    for (unsigned t : counts)
+        std::printf("%7u | %17.0f | %15.0f\n", t, opsPerSecond(sharded, t), opsPerSecond(single, t));
+    return 0;
+}
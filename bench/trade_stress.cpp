@@ -0,0 +1,166 @@
+// ------------------------------------------------------------
+// TradeEngine stress run – randomized concurrent trades between a
+// small set of players (lots of lock overlap), then a conservation
+// check: the units of every (id, rarity, rolled stats) across all
+// inventories must be unchanged. Non‑stackable goods are seeded with a
+// different rarity and damage per copy, so a trade that hands over one
+// copy but deletes another shows up. Exits with 1 if anything was
+// created, destroyed or swapped, or if a bag loaded over its limits
+// cannot give items away.
+// ------------------------------------------------------------
+#include "trade.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+constexpr std::uint64_t kPlayers = 64;
+constexpr int kIds = 8;
+constexpr int kTradesPerThread = 50000;
+
+Item makeItem(int k, int stackSize, Rarity rarity = Rarity::Common, int damage = 5) {
+    ItemTemplate t;
+    t.id       = ItemIds::intern("trade_good_" + std::to_string(k));
+    t.name     = "Trade Good " + std::to_string(k);
+    t.type     = k % 2 ? ItemType::Material : ItemType::Weapon;
+    t.maxStack = k % 2 ? 20 : 1;
+    if (k % 2) t.data = MaterialData{1};
+    else       t.data = WeaponData{5, 100, 3};
+    Item it(ItemTemplates::intern(std::move(t)), stackSize);
+    it.rarity = rarity;
+    if (auto* w = std::get_if<WeaponData>(&it.data)) w->damage = damage;
+    return it;
+}
+
+// (id, rarity, damage) → units held across every inventory
+using Census = std::map<std::tuple<std::uint32_t, int, int>, long long>;
+
+Census census(InventoryRegistry& reg) {
+    Census units;
+    for (std::uint64_t p = 0; p < kPlayers; ++p)
+        reg.with(p, [&](Inventory& inv) {
+            for (const Item& it : inv.getItems()) {
+                auto* w = std::get_if<WeaponData>(&it.data);
+                units[{it.id().value, static_cast<int>(it.rarity), w ? w->damage : 0}] += it.stackSize;
+            }
+            return Result<void>::ok();
+        });
+    return units;
+}
+
+// a bag loaded over both of its limits must still be able to give items
+// away (remove‑only batch and a one‑way trade) but not take any more in
+bool overLimitCanShed(InventoryRegistry& reg, ItemId material) {
+    const std::uint64_t full = kPlayers, other = kPlayers + 1;
+    Inventory src(40, 100000);
+    src.addItem(makeItem(1, 60));                       // 3 stacks, weight 60
+    reg.create(full, 2, 20);
+    reg.create(other, 40, 100000);
+    reg.with(full, [&](Inventory& inv) { return inv.deserialize(src.serialize()); });
+
+    bool removes = static_cast<bool>(reg.with(full, [&](Inventory& inv) {
+        return inv.applyBatch({InventoryOp::remove(material, 5)});
+    }));
+    bool growthRejected = !reg.with(full, [&](Inventory& inv) {
+        return inv.canApplyBatch({InventoryOp::add(makeItem(1, 1))});
+    });
+    TradeEngine engine(reg);
+    bool gives = static_cast<bool>(engine.transfer(full, other, material, 25));
+
+    reg.erase(full);
+    reg.erase(other);
+    std::printf("over-limit bag: remove-only batch %s, one-way trade %s, growth %s\n",
+                removes ? "ok" : "REJECTED", gives ? "ok" : "REJECTED",
+                growthRejected ? "rejected" : "ACCEPTED");
+    return removes && gives && growthRejected;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    unsigned threads = std::max(4u, std::thread::hardware_concurrency());
+    if (argc > 1) threads = std::max(1, std::atoi(argv[1]));
+
+    InventoryRegistry reg;
+    std::vector<ItemId> ids;
+    for (int k = 0; k < kIds; ++k) ids.push_back(makeItem(k, 1).id());
+
+    for (std::uint64_t p = 0; p < kPlayers; ++p) {
+        reg.create(p, 40, 100000);
+        reg.with(p, [&](Inventory& inv) {
+            for (int k = 0; k < kIds; ++k) {
+                if (k % 2) {
+                    auto r = inv.addItem(makeItem(k, 30));
+                    if (!r) return r;
+                    continue;
+                }
+                for (int copy = 0; copy < 2; ++copy) {          // two distinct rolls per id
+                    auto rarity = static_cast<Rarity>((p + copy * 3) % kRarityCount);
+                    auto r = inv.addItem(makeItem(k, 1, rarity, 5 + static_cast<int>(p) * 2 + copy));
+                    if (!r) return r;
+                }
+            }
+            return Result<void>::ok();
+        });
+    }
+
+    const bool shed = overLimitCanShed(reg, ids[1]);
+    const Census before = census(reg);
+
+    TradeEngine engine(reg);
+    std::atomic<long long> committed{0}, rejected{0};
+    std::vector<std::thread> pool;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t] {
+            std::mt19937 rng(t * 7919 + 1);
+            std::uniform_int_distribution<std::uint64_t> player(0, kPlayers - 1);
+            std::uniform_int_distribution<int> item(0, kIds - 1), qty(1, 25), legs(0, 3);
+            auto leg = [&] {
+                int k = item(rng);
+                return TradeLeg{ids[k], k % 2 ? qty(rng) : 1 + qty(rng) % 2};
+            };
+            for (int i = 0; i < kTradesPerThread; ++i) {
+                std::uint64_t a = player(rng), b = player(rng);
+                std::vector<TradeLeg> aGives, bGives;
+                for (int n = legs(rng); n > 0; --n) aGives.push_back(leg());
+                for (int n = legs(rng); n > 0; --n) bGives.push_back(leg());
+                if (engine.trade(a, aGives, b, bGives)) ++committed;
+                else                                    ++rejected;
+            }
+        });
+    }
+    for (auto& th : pool) th.join();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const Census after = census(reg);
+    bool conserved = before == after;
+    for (const auto& [key, units] : before) {
+        auto it = after.find(key);
+        long long now = it == after.end() ? 0 : it->second;
+        if (now != units)
+            std::printf("'%s' %s dmg %d: %lld before, %lld after\n",
+                        ItemIds::name(ItemId{std::get<0>(key)}).c_str(),
+                        toString(static_cast<Rarity>(std::get<1>(key))).c_str(), std::get<2>(key), units, now);
+    }
+    for (const auto& [key, units] : after)
+        if (!before.count(key))
+            std::printf("'%s' %s dmg %d: appeared (%lld units)\n",
+                        ItemIds::name(ItemId{std::get<0>(key)}).c_str(),
+                        toString(static_cast<Rarity>(std::get<1>(key))).c_str(), std::get<2>(key), units);
+
+    std::printf("%u threads | %lld committed, %lld rejected | %.0f trades/s | %s\n",
+                threads, committed.load(), rejected.load(),
+                (committed + rejected) / secs, conserved ? "items conserved" : "CONSERVATION FAILED");
+    return conserved && shed ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+// ------------------------------------------------------------
+// Weight audit benchmark – the nightly InventoryStore::auditWeights()
+// pass over many players: the old per-row std::visit over the payload
+// vs. the hoisted unitWeight column summed with WeightSum::dot
+// (AVX2 when built with -DRPG_ENABLE_AVX2=ON, scalar otherwise), plus
+// the recomputeTotals / recomputeStats population passes. Also checks
+// that a removed or never‑added PlayerId is rejected instead of writing
+// rows the next addPlayer() hands out.
+// ------------------------------------------------------------
+#include "inventory_store.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+Item makeItem(const std::string& id, int stackSize, int weight) {
+    ItemTemplate t;
+    t.id       = ItemIds::intern(id);
+    t.name     = id;
+    t.type     = ItemType::Material;
+    t.maxStack = 20;
+    t.data     = MaterialData{weight};
+    return Item(ItemTemplates::intern(std::move(t)), stackSize);
+}
+
+template <typename F>
+double msPerPass(int passes, F&& pass) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < passes; ++i) pass();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count() / passes;
+}
+
+void run(std::size_t players) {
+    constexpr std::size_t kSlots = 30;
+    constexpr int kPasses = 10;
+    InventoryStore store(kSlots, 1 << 30);
+    for (std::size_t p = 0; p < players; ++p) {
+        PlayerId id = store.addPlayer();
+        for (std::size_t s = 0; s < kSlots * 2 / 3; ++s)     // ~2/3 of the slots in use
+            store.addItem(id, makeItem("mat_" + std::to_string((p + s) % 64), 20, 1 + (s % 7)));
+    }
+
+    const auto& ids      = store.ids();
+    const auto& stacks   = store.stackSizes();
+    const auto& payloads = store.payloads();
+    volatile std::int64_t sink = 0;
+
+    // how the audit read weights before the column existed
+    double visited = msPerPass(kPasses, [&] {
+        std::int64_t total = 0;
+        for (std::size_t row = 0; row < ids.size(); ++row)
+            if (ids[row])
+                total += static_cast<std::int64_t>(payloadWeight(store.payload(payloads[row]))) * stacks[row];
+        sink = sink + total;
+    });
+    double scalar = msPerPass(kPasses, [&] {
+        sink = sink + WeightSum::scalar(store.unitWeights().data(), stacks.data(), stacks.size());
+    });
+    double dot = msPerPass(kPasses, [&] {
+        sink = sink + WeightSum::dot(store.unitWeights().data(), stacks.data(), stacks.size());
+    });
+    double audit = msPerPass(kPasses, [&] { sink = sink + static_cast<std::int64_t>(store.auditWeights()); });
+    double totals = msPerPass(kPasses, [&] { sink = sink + static_cast<std::int64_t>(store.recomputeTotals()); });
+    std::vector<InventoryStore::StatTotals> statOut;
+    double stats = msPerPass(kPasses, [&] { store.recomputeStats(statOut); sink = sink + statOut.front().damage; });
+
+    double mb = static_cast<double>(stacks.size()) * 2 * sizeof(std::int32_t) / (1024.0 * 1024.0);
+    std::printf("%8zu players (%5.1f MB) | visit %8.2f ms | scalar %7.2f ms | dot %7.2f ms (%6.1f GB/s) | auditWeights %7.2f ms"
+                " | recomputeTotals %7.2f ms | recomputeStats %7.2f ms\n",
+                players, mb, visited, scalar, dot, mb / 1024.0 / (dot / 1000.0), audit, totals, stats);
+}
+
+// a removed player's id must not reach the rows its successor gets
+bool removedPlayerRejected() {
+    InventoryStore store(4, 1000);
+    PlayerId gone = store.addPlayer();
+    store.removePlayer(gone);
+    bool addRejected    = !store.addItem(gone, makeItem("mat_0", 5, 1));
+    bool removeRejected = !store.removeItem(gone, ItemIds::find("mat_0"));
+    bool unknownRejected = !store.addItem(gone + 100, makeItem("mat_0", 5, 1));
+    PlayerId next = store.addPlayer();                      // reuses the rows
+    bool clean = next == gone && store.usedSlots(next) == 0 && store.totalWeight(next) == 0 &&
+                 store.getItems(next).empty();
+    bool ok = addRejected && removeRejected && unknownRejected && clean;
+    std::printf("removed player | add %s, remove %s, unknown id %s, reused rows %s\n",
+                addRejected ? "rejected" : "ACCEPTED", removeRejected ? "rejected" : "ACCEPTED",
+                unknownRejected ? "rejected" : "ACCEPTED", clean ? "empty" : "HOLD LEFTOVERS");
+    return ok;
+}
+
+} // namespace
+
+int main() {
+#if defined(__AVX2__)
+    std::printf("WeightSum::dot = AVX2\n");
+#else
+    std::printf("WeightSum::dot = scalar\n");
+#endif
+    for (std::size_t players : {std::size_t{1000}, std::size_t{100000}})
+        run(players);
+    return removedPlayerRejected() ? 0 : 1;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*======================================================================
+ *  11) AliasTable – O(1) weighted sampling (Vose's alias method)
+ *      Built once from integer weights; every draw is one bucket pick
+ *      plus one threshold compare, whatever the number of entries.
+ *      The static build/sample pair works on caller‑owned arrays so
+ *      many small tables can share one flat allocation (LootTables).
+ *====================================================================*/
+class AliasTable {
+public:
+    AliasTable() = default;
+
+    // zero weights are never drawn; an all‑zero or empty input leaves
+    // the table empty()
+    explicit AliasTable(const std::vector<std::uint32_t>& weights) { build(weights); }
+
+    void build(const std::vector<std::uint32_t>& weights) {
+        threshold_.resize(weights.size());
+        alias_.resize(weights.size());
+        if (!build(weights.data(), weights.size(), threshold_.data(), alias_.data())) {
+            threshold_.clear();
+            alias_.clear();
+        }
+    }
+
+    bool empty() const { return threshold_.empty(); }
+    std::size_t size() const { return threshold_.size(); }
+
+    // index in [0, size()); `rng` must yield at least 32 random bits
+    template <typename Rng>
+    std::size_t sample(Rng& rng) const { return sample(threshold_.data(), alias_.data(), threshold_.size(), rng); }
+
+    // fills threshold[0..n) / alias[0..n); false if every weight is zero
+    static bool build(const std::uint32_t* weights, std::size_t n,
+                      std::uint64_t* threshold, std::uint32_t* alias) {
+        std::uint64_t total = 0;
+        for (std::size_t i = 0; i < n; ++i) total += weights[i];
+        if (total == 0) return false;
+
+        // scaled[i] = weight * n; a bucket is "full" at exactly `total`
+        std::vector<std::uint64_t> scaled(n);
+        std::vector<std::uint32_t> small, large;
+        for (std::size_t i = 0; i < n; ++i) {
+            scaled[i] = static_cast<std::uint64_t>(weights[i]) * n;
+            (scaled[i] < total ? small : large).push_back(static_cast<std::uint32_t>(i));
+        }
+        while (!small.empty() && !large.empty()) {
+            std::uint32_t s = small.back(); small.pop_back();
+            std::uint32_t l = large.back();
+            threshold[s] = toThreshold(scaled[s], total);
+            alias[s]     = l;
+            scaled[l]   -= total - scaled[s];           // l donates the rest of s's bucket
+            if (scaled[l] < total) { large.pop_back(); small.push_back(l); }
+        }
+        // leftovers are full buckets (up to rounding)
+        for (std::uint32_t i : large) { threshold[i] = kAlways; alias[i] = i; }
+        for (std::uint32_t i : small) { threshold[i] = kAlways; alias[i] = i; }
+        return true;
+    }
+
+    template <typename Rng>
+    static std::size_t sample(const std::uint64_t* threshold, const std::uint32_t* alias,
+                              std::size_t n, Rng& rng) {
+        static_assert(Rng::max() - Rng::min() >= 0xFFFFFFFFu, "AliasTable needs a 32-bit generator");
+        std::uint64_t pick = static_cast<std::uint32_t>(rng() - Rng::min());
+        std::size_t i = static_cast<std::size_t>((pick * n) >> 32);
+        std::uint64_t coin = static_cast<std::uint32_t>(rng() - Rng::min());
+        return coin < threshold[i] ? i : alias[i];
+    }
+
+private:
+    static constexpr std::uint64_t kAlways = std::uint64_t{1} << 32;   // > any 32‑bit coin
+
+    // scaled / total as a fraction of 2^32 (double keeps 53 bits – plenty)
+    static std::uint64_t toThreshold(std::uint64_t scaled, std::uint64_t total) {
+        return static_cast<std::uint64_t>(static_cast<double>(scaled) / static_cast<double>(total) * 4294967296.0);
+    }
+
+    std::vector<std::uint64_t> threshold_;   // keep bucket i when coin < threshold_[i]
+    std::vector<std::uint32_t> alias_;       // otherwise take alias_[i]
+};
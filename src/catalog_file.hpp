@@ -0,0 +1,391 @@
+#pragma once
+
+#include "item.hpp"
+#include "item_id.hpp"
+#include "item_factory.hpp"
+#include "crafting.hpp"
+#include "result.hpp"
+#include "logger.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define RPG_CATALOG_MMAP 1
+#endif
+
+/*======================================================================
+ *  16) CatalogFile – precompiled binary templates + recipes
+ *      compile() turns templates.json / recipes.json into one flat file:
+ *        Header | TemplateRec[] | RecipeRec[] | IngredientRec[] | strings
+ *      load() maps it and feeds the records straight to ItemFactory and
+ *      CraftingSystem – no tokenizer, no json DOM. The header keeps the
+ *      size and mtime of both source files; if either changed, or the
+ *      magic / version / byte order do not match, load() falls back to
+ *      the JSON files. Bump kVersion whenever a record layout changes.
+ *====================================================================*/
+class CatalogFile {
+public:
+    static constexpr std::uint32_t kVersion = 1;
+
+    // JSON → binary; writes to a temp file first so readers never see half
+    static Result<void> compile(const std::string& templatesJson, const std::string& recipesJson,
+                                const std::string& outPath) {
+        auto templates = ItemFactory::readTemplates(templatesJson);
+        if (!templates) return Result<void>::err(templates.error());
+        auto recipes = CraftingSystem::readRecipes(recipesJson);
+        if (!recipes) return Result<void>::err(recipes.error());
+
+        Writer w;
+        for (const ItemTemplate& t : templates.value()) {
+            TemplateRec rec{};
+            rec.id       = w.string(ItemIds::name(t.id));
+            rec.name     = w.string(t.name);
+            rec.type     = static_cast<std::uint8_t>(t.type);
+            rec.slot     = static_cast<std::uint8_t>(t.slot);
+            rec.payload  = static_cast<std::uint8_t>(t.data.index());
+            rec.maxStack = t.maxStack;
+            packPayload(t.data, rec.stats);
+            w.templates.push_back(rec);
+        }
+        for (const Recipe& r : recipes.value()) {
+            RecipeRec rec{};
+            rec.result          = w.string(ItemIds::name(r.resultId));
+            rec.resultCount     = r.resultCount;
+            rec.firstIngredient = static_cast<std::uint32_t>(w.ingredients.size());
+            rec.ingredientCount = static_cast<std::uint32_t>(r.ingredients.size());
+            for (const auto& [id, qty] : r.ingredients)
+                w.ingredients.push_back({w.string(ItemIds::name(id)), qty});
+            w.recipes.push_back(rec);
+        }
+
+        Header h{};
+        std::memcpy(h.magic, kMagic, sizeof h.magic);
+        h.version         = kVersion;
+        h.byteOrder       = kByteOrder;
+        h.templatesSource = stamp(templatesJson);
+        h.recipesSource   = stamp(recipesJson);
+        h.templateCount   = static_cast<std::uint32_t>(w.templates.size());
+        h.recipeCount     = static_cast<std::uint32_t>(w.recipes.size());
+        h.ingredientCount = static_cast<std::uint32_t>(w.ingredients.size());
+        h.stringBytes     = static_cast<std::uint32_t>(w.strings.size());
+
+        std::vector<char> out(sizeof(Header));
+        h.templateOffset   = w.append(out, w.templates);
+        h.recipeOffset     = w.append(out, w.recipes);
+        h.ingredientOffset = w.append(out, w.ingredients);
+        h.stringOffset     = w.append(out, w.strings);
+        std::memcpy(out.data(), &h, sizeof h);
+
+        const std::string tmp = outPath + ".tmp";
+        {
+            std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+            if (!f) return Result<void>::err("Cannot write catalog '" + tmp + "'");
+            f.write(out.data(), static_cast<std::streamsize>(out.size()));
+            if (!f) return Result<void>::err("Cannot write catalog '" + tmp + "'");
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmp, outPath, ec);
+        if (ec) return Result<void>::err("Cannot replace catalog '" + outPath + "': " + ec.message());
+
+        Log::info("Compiled " + std::to_string(h.templateCount) + " templates and " +
+                  std::to_string(h.recipeCount) + " recipes into '" + outPath + "'.");
+        return Result<void>::ok();
+    }
+
+    // true if `binPath` exists, is readable by this build and was compiled
+    // from the current JSON files (a missing JSON file makes it stale too)
+    static bool isCurrent(const std::string& binPath, const std::string& templatesJson,
+                          const std::string& recipesJson) {
+        MappedFile file(binPath);
+        return file && check(file, templatesJson, recipesJson).empty();
+    }
+
+    // binary when current, otherwise the JSON files. Nothing is published
+    // until the whole file decoded; if the recipes cannot be published
+    // after the templates were, only the recipes come from JSON.
+    static Result<void> load(const std::string& binPath, const std::string& templatesJson,
+                             const std::string& recipesJson, ItemFactory& factory, CraftingSystem& crafting) {
+        MappedFile file(binPath);
+        std::string why = file ? check(file, templatesJson, recipesJson) : "not found";
+        if (why.empty()) {
+            std::vector<ItemTemplate> templates;
+            std::vector<Recipe> recipes;
+            auto r = decode(file, templates, recipes);
+            if (r) r = factory.replaceTemplates(std::move(templates));
+            if (r) {
+                auto rec = crafting.replaceRecipes(std::move(recipes));
+                if (rec) return rec;
+                Log::warn("Catalog '" + binPath + "' recipes not used (" + rec.error() + "), loading JSON.");
+                return crafting.loadFromFile(recipesJson);
+            }
+            why = r.error();
+        }
+        Log::info("Catalog '" + binPath + "' not used (" + why + "), loading JSON.");
+        if (auto r = factory.loadTemplates(templatesJson); !r) return r;
+        return crafting.loadFromFile(recipesJson);
+    }
+
+private:
+    static constexpr char          kMagic[8]  = {'R', 'P', 'G', 'C', 'A', 'T', '\0', '\0'};
+    static constexpr std::uint32_t kByteOrder = 0x01020304;   // reads back swapped on the other endianness
+
+    struct SourceStamp {
+        std::uint64_t size{0};
+        std::int64_t  mtime{0};             // file_time_type ticks; 0/0 = file missing
+    };
+    struct StrRef {
+        std::uint32_t offset{0}, length{0};  // into the string blob
+    };
+    struct Header {
+        char          magic[8];
+        std::uint32_t version, byteOrder;
+        SourceStamp   templatesSource, recipesSource;
+        std::uint32_t templateCount, recipeCount, ingredientCount, stringBytes;
+        std::uint64_t templateOffset, recipeOffset, ingredientOffset, stringOffset;
+    };
+    struct TemplateRec {
+        StrRef        id, name;
+        std::uint8_t  type, slot, payload, pad;
+        std::int32_t  maxStack;
+        std::int32_t  stats[3];             // payload fields in declaration order
+    };
+    struct RecipeRec {
+        StrRef        result;
+        std::int32_t  resultCount;
+        std::uint32_t firstIngredient, ingredientCount;
+    };
+    struct IngredientRec {
+        StrRef        id;
+        std::int32_t  quantity;
+    };
+    static_assert(std::is_trivially_copyable_v<Header> && std::is_trivially_copyable_v<TemplateRec> &&
+                  std::is_trivially_copyable_v<RecipeRec> && std::is_trivially_copyable_v<IngredientRec>,
+                  "catalog records are mapped straight from disk");
+
+    // read‑only view of a whole file: mmap where available, else one read
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::string& path) {
+#ifdef RPG_CATALOG_MMAP
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) return;
+            struct stat st{};
+            if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+                void* p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p != MAP_FAILED) {
+                    data_ = static_cast<const char*>(p);
+                    size_ = static_cast<std::size_t>(st.st_size);
+                }
+            }
+            ::close(fd);                     // the mapping stays valid
+#else
+            std::ifstream in(path, std::ios::binary | std::ios::ate);
+            if (!in) return;
+            auto n = static_cast<std::size_t>(in.tellg());
+            copy_.resize((n + 7) / 8);       // uint64_t storage keeps records aligned
+            in.seekg(0);
+            if (in.read(reinterpret_cast<char*>(copy_.data()), static_cast<std::streamsize>(n))) {
+                data_ = reinterpret_cast<const char*>(copy_.data());
+                size_ = n;
+            }
+#endif
+        }
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile() {
+#ifdef RPG_CATALOG_MMAP
+            if (data_) ::munmap(const_cast<char*>(data_), size_);
+#endif
+        }
+
+        explicit operator bool() const { return data_ != nullptr; }
+        const char* data() const { return data_; }
+        std::size_t size() const { return size_; }
+
+    private:
+        const char* data_{nullptr};
+        std::size_t size_{0};
+#ifndef RPG_CATALOG_MMAP
+        std::vector<std::uint64_t> copy_;
+#endif
+    };
+
+    struct Writer {
+        std::vector<TemplateRec>   templates;
+        std::vector<RecipeRec>     recipes;
+        std::vector<IngredientRec> ingredients;
+        std::vector<char>          strings;
+
+        StrRef string(std::string_view s) {
+            StrRef r{static_cast<std::uint32_t>(strings.size()), static_cast<std::uint32_t>(s.size())};
+            strings.insert(strings.end(), s.begin(), s.end());
+            return r;
+        }
+
+        // pads `out` to 8 bytes, appends the array, returns its offset
+        template <typename T>
+        static std::uint64_t append(std::vector<char>& out, const std::vector<T>& v) {
+            out.resize((out.size() + 7) & ~std::size_t{7});
+            std::uint64_t offset = out.size();
+            const char* bytes = reinterpret_cast<const char*>(v.data());
+            out.insert(out.end(), bytes, bytes + v.size() * sizeof(T));
+            return offset;
+        }
+    };
+
+    static SourceStamp stamp(const std::string& path) {
+        std::error_code ec;
+        auto size = std::filesystem::file_size(path, ec);
+        if (ec) return {};
+        auto time = std::filesystem::last_write_time(path, ec);
+        if (ec) return {};
+        return {static_cast<std::uint64_t>(size), static_cast<std::int64_t>(time.time_since_epoch().count())};
+    }
+
+    static const Header& header(const MappedFile& f) { return *reinterpret_cast<const Header*>(f.data()); }
+
+    // typed view of `count` records at `offset`; nullptr if out of bounds
+    template <typename T>
+    static const T* section(const MappedFile& f, std::uint64_t offset, std::uint64_t count) {
+        if (offset % alignof(T) != 0 || offset > f.size() || count > (f.size() - offset) / sizeof(T))
+            return nullptr;
+        return reinterpret_cast<const T*>(f.data() + offset);
+    }
+
+    // why the file cannot be used; empty if it can
+    static std::string check(const MappedFile& f, const std::string& templatesJson, const std::string& recipesJson) {
+        if (f.size() < sizeof(Header)) return "truncated";
+        const Header& h = header(f);
+        if (std::memcmp(h.magic, kMagic, sizeof kMagic) != 0) return "not a catalog";
+        if (h.byteOrder != kByteOrder) return "other byte order";
+        if (h.version != kVersion) return "version " + std::to_string(h.version);
+
+        // a deleted or renamed source counts as changed: the catalog was
+        // built from something that is no longer there
+        auto sourceState = [](const SourceStamp& built, const std::string& path) -> std::string {
+            SourceStamp now = stamp(path);
+            if (now.size == 0 && now.mtime == 0) return "'" + path + "' missing";
+            if (now.size != built.size || now.mtime != built.mtime) return "'" + path + "' changed";
+            return {};
+        };
+        if (auto why = sourceState(h.templatesSource, templatesJson); !why.empty()) return why;
+        if (auto why = sourceState(h.recipesSource, recipesJson); !why.empty())     return why;
+
+        if (!section<TemplateRec>(f, h.templateOffset, h.templateCount) ||
+            !section<RecipeRec>(f, h.recipeOffset, h.recipeCount) ||
+            !section<IngredientRec>(f, h.ingredientOffset, h.ingredientCount) ||
+            !section<char>(f, h.stringOffset, h.stringBytes))
+            return "section out of bounds";
+        return {};
+    }
+
+    // the payload alternative payloadFromJson picks for `type`
+    static std::size_t payloadIndexFor(ItemType type) {
+        switch (type) {
+            case ItemType::Weapon:     return variantIndex<WeaponData>();
+            case ItemType::Armor:      return variantIndex<ArmorData>();
+            case ItemType::Consumable: return variantIndex<ConsumableData>();
+            case ItemType::Material:   return variantIndex<MaterialData>();
+            default:                   return variantIndex<MiscData>();
+        }
+    }
+    template <typename D>
+    static constexpr std::size_t variantIndex() { return ItemPayload(D{}).index(); }
+
+    // records → templates/recipes; publishes nothing. Every record and
+    // string bound is checked before the first id is interned, so a
+    // corrupt file leaves nothing behind in the process‑wide ItemIds table
+    static Result<void> decode(const MappedFile& f, std::vector<ItemTemplate>& templates,
+                               std::vector<Recipe>& recipes) {
+        const Header&        h    = header(f);
+        const TemplateRec*   trec = section<TemplateRec>(f, h.templateOffset, h.templateCount);
+        const RecipeRec*     rrec = section<RecipeRec>(f, h.recipeOffset, h.recipeCount);
+        const IngredientRec* irec = section<IngredientRec>(f, h.ingredientOffset, h.ingredientCount);
+        const char*          blob = section<char>(f, h.stringOffset, h.stringBytes);
+
+        auto inBlob = [&](StrRef r) { return r.offset <= h.stringBytes && r.length <= h.stringBytes - r.offset; };
+        auto str    = [&](StrRef r) { return std::string_view(blob + r.offset, r.length); };
+
+        // 1) validate everything
+        for (std::uint32_t i = 0; i < h.templateCount; ++i) {
+            const TemplateRec& rec = trec[i];
+            if (rec.type > static_cast<std::uint8_t>(ItemType::Misc) ||
+                rec.slot > static_cast<std::uint8_t>(EquipSlot::None) ||
+                rec.payload != payloadIndexFor(static_cast<ItemType>(rec.type)))
+                return Result<void>::err("bad template record " + std::to_string(i));
+            if (!inBlob(rec.id) || !inBlob(rec.name))
+                return Result<void>::err("string out of bounds in template record " + std::to_string(i));
+        }
+        for (std::uint32_t i = 0; i < h.recipeCount; ++i) {
+            const RecipeRec& rec = rrec[i];
+            if (rec.firstIngredient > h.ingredientCount || rec.ingredientCount > h.ingredientCount - rec.firstIngredient)
+                return Result<void>::err("bad recipe record " + std::to_string(i));
+            if (!inBlob(rec.result))
+                return Result<void>::err("string out of bounds in recipe record " + std::to_string(i));
+        }
+        for (std::uint32_t k = 0; k < h.ingredientCount; ++k)
+            if (!inBlob(irec[k].id))
+                return Result<void>::err("string out of bounds in ingredient record " + std::to_string(k));
+
+        // 2) build – nothing below can fail
+        templates.assign(h.templateCount, ItemTemplate{});
+        for (std::uint32_t i = 0; i < h.templateCount; ++i) {
+            const TemplateRec& rec = trec[i];
+            ItemTemplate& t = templates[i];
+            t.id       = ItemIds::intern(str(rec.id));
+            t.name     = std::string(str(rec.name));
+            t.type     = static_cast<ItemType>(rec.type);
+            t.slot     = static_cast<EquipSlot>(rec.slot);
+            t.maxStack = rec.maxStack;
+            t.data     = unpackPayload(rec.payload, rec.stats);
+        }
+
+        recipes.assign(h.recipeCount, Recipe{});
+        for (std::uint32_t i = 0; i < h.recipeCount; ++i) {
+            const RecipeRec& rec = rrec[i];
+            Recipe& r = recipes[i];
+            r.resultId    = ItemIds::intern(str(rec.result));
+            r.resultCount = rec.resultCount;
+            r.ingredients.reserve(rec.ingredientCount);
+            for (std::uint32_t k = 0; k < rec.ingredientCount; ++k) {
+                const IngredientRec& ing = irec[rec.firstIngredient + k];
+                r.ingredients.emplace_back(ItemIds::intern(str(ing.id)), ing.quantity);
+            }
+        }
+        return Result<void>::ok();
+    }
+
+    static void packPayload(const ItemPayload& data, std::int32_t (&stats)[3]) {
+        std::visit([&stats](const auto& d) {
+            using D = std::decay_t<decltype(d)>;
+            if constexpr (std::is_same_v<D, WeaponData>)          { stats[0] = d.damage; stats[1] = d.durability; stats[2] = d.weight; }
+            else if constexpr (std::is_same_v<D, ArmorData>)      { stats[0] = d.defense; stats[1] = d.weight; }
+            else if constexpr (std::is_same_v<D, ConsumableData>) { stats[0] = d.healAmount; stats[1] = d.weight; }
+            else                                                  { stats[0] = d.weight; }
+        }, data);
+    }
+
+    static ItemPayload unpackPayload(std::uint8_t index, const std::int32_t (&stats)[3]) {
+        switch (index) {
+            case 0:  return WeaponData{stats[0], stats[1], stats[2]};
+            case 1:  return ArmorData{stats[0], stats[1]};
+            case 2:  return ConsumableData{stats[0], stats[1]};
+            case 3:  return MaterialData{stats[0]};
+            default: return MiscData{stats[0]};
+        }
+    }
+};
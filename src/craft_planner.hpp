@@ -0,0 +1,261 @@
+#pragma once
+
+#include "crafting.hpp"
+#include "inventory.hpp"
+#include "item_id.hpp"
+#include "result.hpp"
+#include "logger.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/*======================================================================
+ *  17) CraftPlanner – multi‑level crafting over the recipe DAG
+ *      The current RecipeBook is compiled once into flat nodes/edges
+ *      (one node per item that appears in any recipe) and checked for
+ *      cycles. Per target, the reachable sub‑graph is cached as a
+ *      topological order, so a query is one pass over that array:
+ *      demand flows from the target down to the raw materials, stock
+ *      is used before crafting, and whatever raw material is left over
+ *      is the shortfall. Recompiles by itself when the book is
+ *      reloaded. Not thread‑safe – one planner per thread/session.
+ *====================================================================*/
+struct PlanLine {
+    ItemId item;
+    int    needed{0};        // units this plan uses (target: units requested)
+    int    fromStock{0};     // taken from the inventory
+    int    crafts{0};        // recipe runs; 0 for raw materials
+    int    missing{0};       // raw material the inventory is short of
+};
+
+struct CraftPlan {
+    ItemId target;
+    int    quantity{0};
+    std::vector<PlanLine> lines;                          // ingredients first: craft in this order
+    std::vector<std::pair<ItemId, int>> shortfall;        // raw id → units missing
+
+    bool feasible() const { return shortfall.empty(); }
+};
+
+class CraftPlanner {
+public:
+    explicit CraftPlanner(const CraftingSystem& crafting) : crafting_(&crafting) {}
+
+    // full craft tree for `quantity` × target; crafted items already in
+    // the bag are not counted towards the target itself
+    Result<CraftPlan> plan(const Inventory& inv, ItemId target, int quantity = 1) {
+        auto order = orderFor(target);
+        if (!order) return Result<CraftPlan>::err(order.error());
+        const std::vector<std::uint32_t>& nodes = *order.value();
+        loadStock(inv, nodes);
+        run(nodes, quantity);
+
+        CraftPlan out;
+        out.target   = target;
+        out.quantity = quantity;
+        for (std::uint32_t n : nodes) {
+            if (demand_[n] == 0) continue;
+            PlanLine line{nodes_[n].id, clampInt(demand_[n]), clampInt(fromStock_[n]),
+                          clampInt(crafts_[n]), clampInt(missing_[n])};
+            if (line.missing > 0) out.shortfall.emplace_back(line.item, line.missing);
+            out.lines.push_back(line);
+        }
+        return Result<CraftPlan>::ok(std::move(out));
+    }
+    Result<CraftPlan> plan(const Inventory& inv, const std::string& target, int quantity = 1) {
+        return plan(inv, ItemIds::find(target), quantity);
+    }
+
+    // most targets the inventory can produce through any depth of recipes
+    Result<int> maxCraftable(const Inventory& inv, ItemId target) {
+        auto order = orderFor(target);
+        if (!order) return Result<int>::err(order.error());
+        const std::vector<std::uint32_t>& nodes = *order.value();
+        loadStock(inv, nodes);
+
+        // grow until infeasible, then bisect; each probe is one pass
+        std::int64_t lo = 0, hi = 1;
+        while (hi <= kMaxQuantity && run(nodes, hi)) { lo = hi; hi *= 2; }
+        if (hi > kMaxQuantity) return Result<int>::ok(static_cast<int>(lo));
+        while (hi - lo > 1) {
+            std::int64_t mid = lo + (hi - lo) / 2;
+            (run(nodes, mid) ? lo : hi) = mid;
+        }
+        return Result<int>::ok(static_cast<int>(lo));
+    }
+    Result<int> maxCraftable(const Inventory& inv, const std::string& target) {
+        return maxCraftable(inv, ItemIds::find(target));
+    }
+
+private:
+    static constexpr std::int64_t kMaxQuantity = std::numeric_limits<int>::max() / 2;
+    static constexpr std::int64_t kSaturate    = std::int64_t{1} << 52;   // demand stops growing here
+    static constexpr std::uint32_t kNoRecipe   = std::numeric_limits<std::uint32_t>::max();
+
+    struct Node {
+        ItemId        id;
+        int           resultCount{1};
+        std::uint32_t firstEdge{kNoRecipe}, edgeCount{0};  // kNoRecipe = raw material
+        bool          cyclic{false};                       // on or reaching a recipe cycle
+    };
+    struct Edge {
+        std::uint32_t node;
+        int           quantity;
+    };
+    // DFS on an explicit stack: recipe chains come from JSON, so their
+    // depth must never become call‑stack depth
+    struct Frame {
+        std::uint32_t node;
+        std::uint32_t edge;                                // next edge to follow
+    };
+
+    const CraftingSystem*             crafting_;
+    Snapshot<RecipeBook>::Ptr         book_;              // what nodes_/edges_ were built from
+    std::uint64_t                     version_{0};        // of book_, checked per query
+    std::vector<Node>                 nodes_;
+    std::vector<Edge>                 edges_;
+    std::unordered_map<ItemId, std::uint32_t> index_;
+    std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> orders_;   // memo: target → topo order
+
+    // per‑node scratch, reused by every query
+    std::vector<std::int64_t> stock_, demand_, fromStock_, crafts_, missing_;
+
+    void compile() {
+        version_ = crafting_->version();
+        book_    = crafting_->book();
+        nodes_.clear();
+        edges_.clear();
+        index_.clear();
+        orders_.clear();
+
+        auto nodeOf = [this](ItemId id) {
+            auto [it, inserted] = index_.try_emplace(id, static_cast<std::uint32_t>(nodes_.size()));
+            if (inserted) nodes_.push_back(Node{id});
+            return it->second;
+        };
+        for (const auto& [id, rec] : book_->recipes) {
+            nodeOf(id);
+            for (const auto& [ing, qty] : rec.ingredients) nodeOf(ing);
+        }
+        for (const auto& [id, rec] : book_->recipes) {
+            Node& n = nodes_[index_.at(id)];
+            n.resultCount = std::max(1, rec.resultCount);
+            n.firstEdge   = static_cast<std::uint32_t>(edges_.size());
+            n.edgeCount   = static_cast<std::uint32_t>(rec.ingredients.size());
+            for (const auto& [ing, qty] : rec.ingredients) edges_.push_back({index_.at(ing), std::max(0, qty)});
+        }
+
+        // colour DFS; a back edge marks the whole path, and anything that
+        // reaches a marked node is marked on the way out
+        enum : std::uint8_t { White, Grey, Black };
+        std::vector<std::uint8_t> colour(nodes_.size(), White);
+        std::vector<Frame> stack;
+        for (std::uint32_t root = 0; root < nodes_.size(); ++root) {
+            if (colour[root] != White) continue;
+            colour[root] = Grey;
+            stack.push_back({root, 0});
+            while (!stack.empty()) {
+                Frame& f = stack.back();
+                const std::uint32_t n = f.node;
+                if (f.edge == nodes_[n].edgeCount) {
+                    colour[n] = Black;
+                    stack.pop_back();
+                    if (nodes_[n].cyclic && !stack.empty()) nodes_[stack.back().node].cyclic = true;
+                    continue;
+                }
+                std::uint32_t c = edges_[nodes_[n].firstEdge + f.edge++].node;
+                if (colour[c] == Grey) {
+                    if (!nodes_[c].cyclic) Log::warn("Recipe cycle through '" + ItemIds::name(nodes_[c].id) + "'");
+                    nodes_[c].cyclic = true;
+                    nodes_[n].cyclic = true;
+                } else if (colour[c] == White) {
+                    colour[c] = Grey;
+                    stack.push_back({c, 0});
+                } else if (nodes_[c].cyclic) {
+                    nodes_[n].cyclic = true;
+                }
+            }
+        }
+
+        for (auto* v : {&stock_, &demand_, &fromStock_, &crafts_, &missing_}) v->assign(nodes_.size(), 0);
+    }
+
+    // post‑order from the target: every ingredient comes before its users
+    Result<const std::vector<std::uint32_t>*> orderFor(ItemId target) {
+        using R = Result<const std::vector<std::uint32_t>*>;
+        if (version_ != crafting_->version() || !book_) compile();
+
+        auto idx = index_.find(target);
+        if (idx == index_.end() || nodes_[idx->second].firstEdge == kNoRecipe)
+            return R::err("no recipe for '" + ItemIds::name(target) + "'");
+        if (nodes_[idx->second].cyclic)
+            return R::err("recipe for '" + ItemIds::name(target) + "' depends on itself");
+
+        auto [memo, fresh] = orders_.try_emplace(idx->second);
+        if (fresh) {
+            std::vector<std::uint8_t> seen(nodes_.size(), 0);
+            std::vector<std::uint32_t>& order = memo->second;
+            std::vector<Frame> stack{{idx->second, 0}};
+            seen[idx->second] = 1;
+            while (!stack.empty()) {
+                Frame& f = stack.back();
+                const Node& node = nodes_[f.node];
+                if (f.edge == node.edgeCount) {
+                    order.push_back(f.node);
+                    stack.pop_back();
+                    continue;
+                }
+                std::uint32_t c = edges_[node.firstEdge + f.edge++].node;
+                if (!seen[c]) {
+                    seen[c] = 1;
+                    stack.push_back({c, 0});
+                }
+            }
+        }
+        return R::ok(&memo->second);
+    }
+
+    void loadStock(const Inventory& inv, const std::vector<std::uint32_t>& nodes) {
+        for (std::uint32_t n : nodes) stock_[n] = inv.count(nodes_[n].id);
+        stock_[nodes.back()] = 0;                      // the target is made, not taken
+    }
+
+    // one demand pass, consumers before ingredients; true if no shortfall
+    bool run(const std::vector<std::uint32_t>& nodes, std::int64_t quantity) {
+        for (std::uint32_t n : nodes) demand_[n] = 0;
+        demand_[nodes.back()] = quantity;
+        bool ok = true;
+        for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) {
+            const std::uint32_t n = *it;
+            const Node& node = nodes_[n];
+            std::int64_t need = demand_[n];
+            fromStock_[n]     = std::min(need, stock_[n]);
+            std::int64_t rest = need - fromStock_[n];
+            crafts_[n] = missing_[n] = 0;
+            if (rest == 0) continue;
+            if (node.firstEdge == kNoRecipe) {
+                missing_[n] = rest;
+                ok = false;
+                continue;
+            }
+            crafts_[n] = (rest + node.resultCount - 1) / node.resultCount;
+            for (std::uint32_t e = 0; e < node.edgeCount; ++e) {
+                const Edge& edge = edges_[node.firstEdge + e];
+                std::int64_t add = edge.quantity != 0 && crafts_[n] > kSaturate / edge.quantity
+                                       ? kSaturate : crafts_[n] * edge.quantity;
+                demand_[edge.node] = std::min(kSaturate, demand_[edge.node] + add);
+            }
+        }
+        return ok;
+    }
+
+    static int clampInt(std::int64_t v) {
+        return static_cast<int>(std::min<std::int64_t>(v, std::numeric_limits<int>::max()));
+    }
+};
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "crafting.hpp"
+#include "item_id.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+/*======================================================================
+ *  18) CraftableSet – recipes craftable right now, kept incrementally
+ *      A reverse index maps each ingredient to the recipes that use it
+ *      (and how many they need); every recipe keeps the number of its
+ *      ingredients the bag is short of. When a count changes only the
+ *      uses of that id are looked at, and a recipe enters or leaves the
+ *      set exactly when its shortage count reaches or leaves zero.
+ *      The owner reports count changes through update(); refresh()
+ *      rebuilds everything after the recipe book was reloaded.
+ *====================================================================*/
+class CraftableSet {
+public:
+    bool attached() const { return source_ != nullptr; }
+
+    template <typename CountFn>
+    void attach(const CraftingSystem& crafting, CountFn&& countOf) {
+        source_ = &crafting;
+        rebuild(countOf);
+    }
+
+    // rebuilds if the book changed since the last build
+    template <typename CountFn>
+    void refresh(CountFn&& countOf) {
+        if (source_ && version_ != source_->version()) rebuild(countOf);
+    }
+
+    // recomputes every shortage from scratch (e.g. after a load)
+    template <typename CountFn>
+    void recount(CountFn&& countOf) {
+        if (!source_) return;
+        craftable_.clear();
+        members_.clear();
+        for (std::uint32_t r = 0; r < results_.size(); ++r) {
+            pos_[r] = kOut;
+            unmet_[r] = 0;
+        }
+        for (const auto& [id, uses] : uses_) {
+            const int have = countOf(id);
+            for (const Use& u : uses)
+                if (have < u.quantity) ++unmet_[u.recipe];
+        }
+        for (std::uint32_t r = 0; r < results_.size(); ++r)
+            if (unmet_[r] == 0) enter(r);
+    }
+
+    // the bag's count of `id` went from `before` to `after`
+    void update(ItemId id, int before, int after) {
+        if (!source_ || before == after) return;
+        auto it = uses_.find(id);
+        if (it == uses_.end()) return;
+        for (const Use& u : it->second) {
+            const bool had = before >= u.quantity, has = after >= u.quantity;
+            if (had == has) continue;
+            if (has) {
+                if (--unmet_[u.recipe] == 0) enter(u.recipe);
+            } else {
+                if (unmet_[u.recipe]++ == 0) leave(u.recipe);
+            }
+        }
+    }
+
+    // result ids, in no particular order
+    const std::vector<ItemId>& items() const { return craftable_; }
+
+    bool contains(ItemId resultId) const {
+        auto it = recipeOf_.find(resultId);
+        return it != recipeOf_.end() && pos_[it->second] != kOut;
+    }
+
+private:
+    static constexpr std::uint32_t kOut = std::numeric_limits<std::uint32_t>::max();
+
+    struct Use {
+        std::uint32_t recipe;
+        int           quantity;
+    };
+
+    const CraftingSystem*     source_{nullptr};
+    Snapshot<RecipeBook>::Ptr book_;
+    std::uint64_t             version_{0};                     // of book_; a plain load to compare
+    std::unordered_map<ItemId, std::vector<Use>> uses_;        // ingredient → recipes using it
+    std::unordered_map<ItemId, std::uint32_t>    recipeOf_;    // result → recipe index
+    std::vector<ItemId>        results_;                       // recipe index → result
+    std::vector<std::uint32_t> unmet_;                         // ingredients short of
+    std::vector<std::uint32_t> pos_;                           // index in craftable_, kOut if absent
+    std::vector<ItemId>        craftable_;
+    std::vector<std::uint32_t> members_;                       // recipe index of each craftable_ entry
+
+    template <typename CountFn>
+    void rebuild(CountFn& countOf) {
+        version_ = source_->version();                // before the load: a race only rebuilds twice
+        book_    = source_->book();
+        uses_.clear();
+        recipeOf_.clear();
+        results_.clear();
+        for (const auto& [id, rec] : book_->recipes) {
+            auto r = static_cast<std::uint32_t>(results_.size());
+            results_.push_back(id);
+            recipeOf_.emplace(id, r);
+            for (const auto& [ing, qty] : rec.ingredients) uses_[ing].push_back({r, qty});
+        }
+        unmet_.assign(results_.size(), 0);
+        pos_.assign(results_.size(), kOut);
+        recount(countOf);
+    }
+
+    void enter(std::uint32_t r) {
+        pos_[r] = static_cast<std::uint32_t>(craftable_.size());
+        craftable_.push_back(results_[r]);
+        members_.push_back(r);
+    }
+    void leave(std::uint32_t r) {
+        std::uint32_t p = pos_[r];
+        craftable_[p] = craftable_.back();
+        members_[p]   = members_.back();
+        pos_[members_[p]] = p;
+        craftable_.pop_back();
+        members_.pop_back();
+        pos_[r] = kOut;
+    }
+};
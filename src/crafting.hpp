@@ -1,10 +1,19 @@
 #pragma once
 
 #include "json.hpp"
+#include "item_id.hpp"
 #include "result.hpp"
 #include "logger.hpp"
+#include "snapshot.hpp"
 
+#include <atomic>
+#include <cstdint>
+#include <optional>
 #include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <utility>
 #include <string>
 #include <fstream>
 #include <sstream>
@@ -12,66 +21,157 @@
 
 /*======================================================================
  *  5) Crafting – data‑driven recipes (JSON)
+ *     Recipes are published as immutable RecipeBook snapshots, so a
+ *     reload never blocks or invalidates a craft in progress.
  *====================================================================*/
 struct Recipe {
-    std::string resultId;                               // what we produce
+    ItemId      resultId;                               // what we produce
     int         resultCount{1};                         // how many we get
-    std::unordered_map<std::string, int> ingredients;  // id → quantity
+    std::vector<std::pair<ItemId, int>> ingredients;   // id → quantity
 };
 
 inline void to_json(json& j, const Recipe& r){
-    j = json{{"resultId", r.resultId},
+    j = json{{"resultId", ItemIds::name(r.resultId)},
              {"resultCount", r.resultCount},
              {"ingredients", json{} } };
     json ingObj;
-    for (auto& kv : r.ingredients) ingObj[kv.first] = kv.second;
+    for (auto& kv : r.ingredients) ingObj[ItemIds::name(kv.first)] = kv.second;
     j["ingredients"] = ingObj;
 }
 inline void from_json(const json& j, Recipe& r){
-    r.resultId = j.at("resultId").get<std::string>();
+    r.resultId = ItemIds::intern(j.at("resultId").get<std::string>());
     r.resultCount = j.value("resultCount",1);
     const json& ing = j.at("ingredients");
     if (!ing.is_object())
         throw std::runtime_error("ingredients must be an object");
     r.ingredients.clear();
     for (auto it = ing.object_begin(); it != ing.object_end(); ++it) {
-        r.ingredients[it.key()] = it.value().get<int>();
+        r.ingredients.emplace_back(ItemIds::intern(it.key()), it.value().get<int>());
     }
 }
 
+struct RecipeBook {
+    std::unordered_map<ItemId, Recipe> recipes;
+};
+
 class CraftingSystem {
 public:
+    using RecipePtr = std::shared_ptr<const Recipe>;   // pins its RecipeBook
+
+    // publishes the file's recipes as the whole book (one deleted from
+    // the file is gone); safe to call while other threads craft
     Result<void> loadFromFile(const std::string& path) {
+        auto parsed = readRecipes(path);
+        if (!parsed) return Result<void>::err(parsed.error());
+        return replaceRecipes(std::move(parsed.value()));
+    }
+
+    // parses a recipe file without touching any CraftingSystem
+    static Result<std::vector<Recipe>> readRecipes(const std::string& path) {
+        using R = Result<std::vector<Recipe>>;
         std::ifstream in(path);
-        if (!in) return Result<void>::err("Cannot open recipe file '" + path + "'");
+        if (!in) return R::err("Cannot open recipe file '" + path + "'");
         std::string content((std::istreambuf_iterator<char>(in)), {});
         json j;
         try { j = json::parse(content); }
-        catch (const std::exception& e) { return Result<void>::err("JSON parse error: " + std::string(e.what())); }
+        catch (const std::exception& e) { return R::err("JSON parse error: " + std::string(e.what())); }
 
         if (!j.is_array())
-            return Result<void>::err("Recipes file must contain a JSON array");
+            return R::err("Recipes file must contain a JSON array");
 
+        std::vector<Recipe> out;
+        out.reserve(j.size());
         for (const auto& elem : j) {
             try {
-                Recipe rec = elem.get<Recipe>();
-                recipes_[rec.resultId] = rec;
+                out.push_back(elem.get<Recipe>());
             } catch (const std::exception& e) {
                 Log::warn("Failed to parse recipe: " + std::string(e.what()));
             }
         }
+        return R::ok(std::move(out));
+    }
 
-        Log::info("Loaded " + std::to_string(recipes_.size()) + " recipes.");
-        return Result<void>::ok();
+    // adds already‑built recipes to the current book; a result it
+    // already holds gets the new recipe
+    Result<void> addRecipes(std::vector<Recipe> recipes) {
+        return publishRecipes(std::move(recipes), true);
+    }
+
+    // publishes exactly these recipes (from JSON or the binary catalog)
+    // as the new book
+    Result<void> replaceRecipes(std::vector<Recipe> recipes) {
+        return publishRecipes(std::move(recipes), false);
     }
 
-    const Recipe* get(const std::string& resultId) const {
-        auto it = recipes_.find(resultId);
-        return it == recipes_.end() ? nullptr : &it->second;
+    // current snapshot of every recipe
+    Snapshot<RecipeBook>::Ptr book() const { return book_.load(); }
+
+    // bumped by every publish; compare it to notice a reload cheaply
+    std::uint64_t version() const { return book_.version(); }
+
+    // pins the book, so the recipe outlives any later reload
+    RecipePtr get(ItemId resultId) const {
+        auto book = book_.load();
+        auto it = book->recipes.find(resultId);
+        if (it == book->recipes.end()) return nullptr;
+        return RecipePtr(std::move(book), &it->second);   // aliasing: shares the book's lifetime
     }
+    RecipePtr get(const std::string& resultId) const { return get(ItemIds::find(resultId)); }
 
-    bool has(const std::string& resultId) const { return recipes_.count(resultId) > 0; }
+    // hot path: looks in the calling thread's cached view, so a lookup is
+    // one atomic version load plus the hash lookup – no lock, no reference
+    // counting. The pointer is good until this thread's next lookup after
+    // a reload (or on another CraftingSystem); use get() to keep it longer.
+    const Recipe* find(ItemId resultId) const {
+        const RecipeBook& book = view();
+        auto it = book.recipes.find(resultId);
+        return it == book.recipes.end() ? nullptr : &it->second;
+    }
+    const Recipe* find(const std::string& resultId) const { return find(ItemIds::find(resultId)); }
+
+    bool has(ItemId resultId) const { return find(resultId) != nullptr; }
+    bool has(const std::string& resultId) const { return has(ItemIds::find(resultId)); }
 
 private:
-    std::unordered_map<std::string, Recipe> recipes_;
+    Snapshot<RecipeBook> book_;
+    std::mutex           reloadMtx_;                      // serialises book publishes
+    const std::uint64_t  instance_{nextInstance()};       // keys the per‑thread views
+
+    // builds the next book from a copy of the current one (merge) or
+    // from nothing, and publishes it
+    Result<void> publishRecipes(std::vector<Recipe> recipes, bool merge) {
+        std::lock_guard<std::mutex> lock(reloadMtx_);        // one writer at a time
+        auto next = merge ? std::make_shared<RecipeBook>(*book_.load()) : std::make_shared<RecipeBook>();
+        next->recipes.reserve(next->recipes.size() + recipes.size());
+        for (Recipe& rec : recipes) {
+            ItemId id = rec.resultId;
+            next->recipes[id] = std::move(rec);
+        }
+
+        std::size_t count = next->recipes.size();
+        book_.publish(std::move(next));
+        Log::info("Loaded " + std::to_string(count) + " recipes.");
+        return Result<void>::ok();
+    }
+
+    static std::uint64_t nextInstance() {
+        static std::atomic<std::uint64_t> counter{0};
+        return ++counter;
+    }
+
+    // one Snapshot::Reader per thread, rebound when the thread switches to
+    // another CraftingSystem (an id, not the address, so a new system at a
+    // reused address never sees the old one's book)
+    const RecipeBook& view() const {
+        struct Cached {
+            std::uint64_t owner{0};
+            std::optional<Snapshot<RecipeBook>::Reader> reader;
+        };
+        thread_local Cached cached;
+        if (cached.owner != instance_) {
+            cached.reader.emplace(book_);
+            cached.owner = instance_;
+        }
+        return cached.reader->get();
+    }
 };
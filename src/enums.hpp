@@ -1,16 +1,25 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
 
 /*======================================================================
  *  2) Core enums & helpers
  *====================================================================*/
 enum class ItemType   { Weapon, Armor, Consumable, Material, Misc };
 enum class EquipSlot  { Head, Chest, Legs, Weapon, Shield, Accessory, None };
-enum class Rarity     { Common, Uncommon, Rare, Epic, Legendary };
+enum class Rarity : std::uint8_t { Common, Uncommon, Rare, Epic, Legendary };
 enum class Stat       { Attack, Defense, Health, Mana };
 
-inline std::string toString(ItemType t) {
+// number of real equipment slots (EquipSlot::None excluded) – array size
+constexpr std::size_t kEquipSlotCount = static_cast<std::size_t>(EquipSlot::None);
+constexpr std::size_t kItemTypeCount  = static_cast<std::size_t>(ItemType::Misc) + 1;
+constexpr std::size_t kRarityCount    = static_cast<std::size_t>(Rarity::Legendary) + 1;
+
+// string_view forms are for formatters on hot paths; toString wraps them
+inline std::string_view typeName(ItemType t) {
     switch (t) {
         case ItemType::Weapon:     return "Weapon";
         case ItemType::Armor:      return "Armor";
@@ -19,6 +28,7 @@ inline std::string toString(ItemType t) {
         default:                   return "Misc";
     }
 }
+inline std::string toString(ItemType t) { return std::string(typeName(t)); }
 inline ItemType stringToItemType(const std::string& s) {
     if (s == "Weapon") return ItemType::Weapon;
     if (s == "Armor")  return ItemType::Armor;
@@ -36,6 +46,18 @@ inline std::string toString(Rarity r) {
         default:                return "Unknown";
     }
 }
+// display prefix ("Rare Iron Sword"); Common items have none
+inline std::string_view rarityPrefix(Rarity r) {
+    switch (r) {
+        case Rarity::Uncommon:  return "Uncommon";
+        case Rarity::Rare:      return "Rare";
+        case Rarity::Epic:      return "Epic";
+        case Rarity::Legendary: return "Legendary";
+        default:                return "";
+    }
+}
+// stat multiplier ItemFactory applies to a roll of this rarity
+inline float rarityMultiplier(Rarity r) { return 1.0f + static_cast<float>(static_cast<int>(r)) * 0.2f; }
 inline Rarity stringToRarity(const std::string& s) {
     if (s == "Common")    return Rarity::Common;
     if (s == "Uncommon")  return Rarity::Uncommon;
@@ -55,14 +77,42 @@ inline std::string toString(EquipSlot s) {
         default:                    return "None";
     }
 }
-inline std::string rarityColor(Rarity r) {
+inline EquipSlot stringToEquipSlot(const std::string& s) {
+    if (s == "Head")      return EquipSlot::Head;
+    if (s == "Chest")     return EquipSlot::Chest;
+    if (s == "Legs")      return EquipSlot::Legs;
+    if (s == "Weapon")    return EquipSlot::Weapon;
+    if (s == "Shield")    return EquipSlot::Shield;
+    if (s == "Accessory") return EquipSlot::Accessory;
+    return EquipSlot::None;
+}
+// fallback for data that does not declare a slot – run once at load time
+inline EquipSlot deriveEquipSlot(ItemType type, const std::string& id) {
+    if (type == ItemType::Weapon) return EquipSlot::Weapon;
+    if (type == ItemType::Armor) {
+        if (id.find("helmet") != std::string::npos ||
+            id.find("head")   != std::string::npos) return EquipSlot::Head;
+        if (id.find("chest")  != std::string::npos ||
+            id.find("armor")  != std::string::npos) return EquipSlot::Chest;
+        if (id.find("leg")    != std::string::npos ||
+            id.find("boots")  != std::string::npos) return EquipSlot::Legs;
+        return EquipSlot::Chest;
+    }
+    if (id.find("shield") != std::string::npos) return EquipSlot::Shield;
+    if (id.find("ring")   != std::string::npos ||
+        id.find("amulet") != std::string::npos) return EquipSlot::Accessory;
+    return EquipSlot::None;
+}
+inline constexpr std::string_view kResetColor = "\x1B[0m";
+inline std::string_view rarityColorCode(Rarity r) {
     switch (r) {
         case Rarity::Common:    return "\x1B[37m";
         case Rarity::Uncommon:  return "\x1B[32m";
         case Rarity::Rare:      return "\x1B[34m";
         case Rarity::Epic:      return "\x1B[35m";
         case Rarity::Legendary: return "\x1B[33m";
-        default:                return "\x1B[0m";
+        default:                return kResetColor;
     }
 }
-inline std::string resetColor() { return "\x1B[0m"; }
+inline std::string rarityColor(Rarity r) { return std::string(rarityColorCode(r)); }
+inline std::string resetColor() { return std::string(kResetColor); }
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*======================================================================
+ *  15) FileWatcher – calls back when a watched file's mtime changes
+ *      Portable polling (std::filesystem), either on demand via poll()
+ *      or from a background thread after start(). Meant for hot‑reload
+ *      of data files: callbacks run on the watcher thread, so they must
+ *      only do thread‑safe work (e.g. publish a new Snapshot).
+ *====================================================================*/
+class FileWatcher {
+public:
+    using Callback = std::function<void(const std::string& path)>;
+
+    FileWatcher() = default;
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+    ~FileWatcher() { stop(); }
+
+    void watch(std::string path, Callback onChange) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        Watched w{std::move(path), std::move(onChange), {}};
+        w.lastWrite = mtime(w.path);
+        files_.push_back(std::move(w));
+    }
+
+    // checks every file once; returns how many callbacks fired
+    std::size_t poll() {
+        std::vector<std::pair<Callback, std::string>> fire;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            for (Watched& w : files_) {
+                auto now = mtime(w.path);
+                if (now == w.lastWrite) continue;
+                w.lastWrite = now;
+                if (now != Stamp{}) fire.emplace_back(w.onChange, w.path);   // skip deletions
+            }
+        }
+        for (auto& [cb, path] : fire) cb(path);
+        return fire.size();
+    }
+
+    void start(std::chrono::milliseconds interval = std::chrono::milliseconds(500)) {
+        if (thread_.joinable()) return;
+        running_ = true;
+        thread_ = std::thread([this, interval] {
+            std::unique_lock<std::mutex> lock(waitMtx_);
+            while (running_) {
+                lock.unlock();
+                poll();
+                lock.lock();
+                wake_.wait_for(lock, interval, [this] { return !running_; });
+            }
+        });
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(waitMtx_);
+            running_ = false;
+        }
+        wake_.notify_all();
+        if (thread_.joinable()) thread_.join();
+    }
+
+private:
+    using Stamp = std::filesystem::file_time_type;
+
+    struct Watched {
+        std::string path;
+        Callback    onChange;
+        Stamp       lastWrite;
+    };
+
+    static Stamp mtime(const std::string& path) {
+        std::error_code ec;
+        auto t = std::filesystem::last_write_time(path, ec);
+        return ec ? Stamp{} : t;
+    }
+
+    std::mutex              mtx_;        // guards files_
+    std::vector<Watched>    files_;
+
+    std::mutex              waitMtx_;
+    std::condition_variable wake_;
+    bool                    running_{false};
+    std::thread             thread_;
+};
@@ -3,194 +3,456 @@
 #include "item.hpp"
 #include "item_factory.hpp"
 #include "crafting.hpp"
+#include "craftable_set.hpp"
 #include "result.hpp"
 #include "logger.hpp"
 
 #include <vector>
 #include <unordered_map>
-#include <memory>
+#include <array>
+#include <optional>
+#include <set>
+#include <limits>
+#include <type_traits>
 #include <algorithm>
 #include <string>
 #include <cstddef>
+#include <cstdint>
 #include <utility>
+#include <cassert>
+#include <stdexcept>
+
+/*======================================================================
+ *  Stable reference to one inventory slot. The generation is bumped
+ *  every time the slot is freed, so stale handles are detected instead
+ *  of silently pointing at whatever reused the slot.
+ *====================================================================*/
+struct SlotHandle {
+    std::uint32_t index{static_cast<std::uint32_t>(-1)};
+    std::uint32_t generation{0};
+
+    friend bool operator==(SlotHandle a, SlotHandle b) noexcept {
+        return a.index == b.index && a.generation == b.generation;
+    }
+    friend bool operator!=(SlotHandle a, SlotHandle b) noexcept { return !(a == b); }
+};
+
+/*======================================================================
+ *  One step of an Inventory::applyBatch transaction
+ *====================================================================*/
+struct InventoryOp {
+    enum class Kind { Add, Remove, RemoveAt };
+
+    Kind       kind{Kind::Add};
+    Item       item;                // Add: the stack to insert
+    ItemId     id;                  // Remove: which id ...
+    SlotHandle slot;                // RemoveAt: which stack ...
+    int        quantity{0};         // ... and how many units
+
+    static InventoryOp add(Item it) {
+        InventoryOp op;
+        op.kind = Kind::Add;
+        op.item = std::move(it);
+        return op;
+    }
+    static InventoryOp remove(ItemId id, int quantity) {
+        InventoryOp op;
+        op.kind = Kind::Remove;
+        op.id = id;
+        op.quantity = quantity;
+        return op;
+    }
+    static InventoryOp removeAt(SlotHandle slot, int quantity) {
+        InventoryOp op;
+        op.kind = Kind::RemoveAt;
+        op.slot = slot;
+        op.quantity = quantity;
+        return op;
+    }
+};
+
+/*======================================================================
+ *  Running totals over everything currently equipped
+ *====================================================================*/
+struct EquipStats {
+    int damage{0};
+    int defense{0};
+    int weight{0};
+};
+
+/*======================================================================
+ *  Units and weight held of one ItemType / Rarity (bag + equipment)
+ *====================================================================*/
+struct ItemTally {
+    int count{0};
+    int weight{0};
+};
+
+/*======================================================================
+ *  Filter + sort description for Inventory::query
+ *  Sorting by a payload stat (damage/defense/healAmount) only yields
+ *  items that carry that stat.
+ *====================================================================*/
+enum class ItemSortKey { LevelReq, Rarity, Damage, Defense, HealAmount, None };
+constexpr std::size_t kItemSortKeyCount = static_cast<std::size_t>(ItemSortKey::None);
+
+struct ItemQuery {
+    std::optional<ItemType> type;
+    Rarity minRarity{Rarity::Common};
+    Rarity maxRarity{Rarity::Legendary};
+    int minLevelReq{std::numeric_limits<int>::min()};
+    int maxLevelReq{std::numeric_limits<int>::max()};
+    ItemSortKey sortBy{ItemSortKey::None};
+    bool descending{false};
+    std::size_t limit{std::numeric_limits<std::size_t>::max()};
+};
 
 /*======================================================================
  *  6) Inventory – stacking, weight/slot limits, equip slots, persistence
  *====================================================================*/
 class Inventory {
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    struct Slot {
+        Item          item;
+        std::uint32_t generation{0};         // bumped on every free
+        bool          occupied{false};
+        bool          dirty{false};          // touched since the last checkpoint()
+        std::size_t   inSlots{npos};         // position in StackIndex::slots
+        std::size_t   inPartial{npos};       // position in StackIndex::partial
+    };
+
 public:
     explicit Inventory(std::size_t slotLimit = 30, int weightLimit = 300)
         : slotLimit_(slotLimit), weightLimit_(weightLimit) {}
 
     Result<void> addItem(const Item& item) {
-        Item toAdd = item; // work on a copy because we may split stacks
+        auto res = insert(item);
+        if (res) checkTotals();
+        return res;
+    }
 
+private:
+    // addItem without the debug check – equip/unequip call it while the
+    // swapped item is already taken out of the totals
+    Result<void> insert(const Item& item) {
         // ---------- 1) capacity checks (weight + slots) ----------
-        int neededWeight = toAdd.getWeight();
-        if (totalWeight_ + neededWeight > weightLimit_)
+        if (totalWeight_ + item.getWeight() > weightLimit_)
             return Result<void>::err("weight limit exceeded");
 
-        std::size_t neededSlots = 0;
-        if (toAdd.maxStack > 1) {
-            int remaining = toAdd.stackSize;
-            for (const auto& existing : items_) {
-                if (existing.id == toAdd.id && existing.stackSize < existing.maxStack) {
-                    int freeSpace = existing.maxStack - existing.stackSize;
-                    int use = std::min(freeSpace, remaining);
-                    remaining -= use;
-                    if (remaining == 0) break;
-                }
-            }
-            if (remaining > 0)
-                neededSlots = static_cast<std::size_t>((remaining + toAdd.maxStack - 1) / toAdd.maxStack);
-        } else {
-            neededSlots = static_cast<std::size_t>(toAdd.stackSize);
-        }
-
-        if (items_.size() + neededSlots > slotLimit_)
+        if (autoCompact_ && used_ + slotsNeeded(item) > slotLimit_)
+            mergePartials();
+        if (used_ + slotsNeeded(item) > slotLimit_)
             return Result<void>::err("slot limit reached");
 
         // ---------- 2) actual insertion (weight updated) ----------
-        if (toAdd.maxStack > 1) {
-            for (auto& existing : items_) {
-                if (existing.id == toAdd.id && existing.stackSize < existing.maxStack) {
-                    int freeSpace = existing.maxStack - existing.stackSize;
-                    int transfer = std::min(freeSpace, toAdd.stackSize);
-                    existing.stackSize += transfer;
-                    totalWeight_ += existing.weightPerUnit() * transfer;
-                    toAdd.stackSize -= transfer;
-                    if (toAdd.stackSize == 0) break;
+        int remaining = item.stackSize;
+        if (item.maxStack() > 1) {
+            auto idx = index_.find(item.id());
+            if (idx != index_.end()) {
+                // every partial stack except possibly the last one gets filled up,
+                // so this loop is bounded by the number of stacks we touch
+                auto& partial = idx->second.partial;
+                while (remaining > 0 && !partial.empty()) {
+                    std::size_t slot = partial.back();
+                    const Item& existing = slots_[slot].item;
+                    int transfer = std::min(existing.maxStack() - existing.stackSize, remaining);
+                    setStackSize(slot, existing.stackSize + transfer);
+                    remaining -= transfer;
                 }
             }
         }
 
-        while (toAdd.stackSize > 0) {
-            int thisStackSize = std::min(toAdd.stackSize, toAdd.maxStack);
-            Item singleStack = toAdd;
-            singleStack.stackSize = thisStackSize;
-
-            items_.push_back(singleStack);
-            totalWeight_ += singleStack.getWeight();
-
-            toAdd.stackSize -= thisStackSize;
+        while (remaining > 0) {
+            Item singleStack = item;
+            singleStack.stackSize = std::min(remaining, item.maxStack());
+            remaining -= singleStack.stackSize;
+            pushStack(std::move(singleStack));
         }
 
         return Result<void>::ok();
     }
 
+public:
+
     Result<void> removeItem(const std::string& id, int quantity = 1) {
+        return removeItem(ItemIds::find(id), quantity);
+    }
+
+    Result<void> removeItem(ItemId id, int quantity = 1) {
         if (quantity <= 0) return Result<void>::ok();
-        int remaining = quantity;
 
-        for (auto it = items_.begin(); it != items_.end() && remaining > 0; ) {
-            if (it->id == id) {
-                if (it->stackSize > remaining) {
-                    int unitWeight = it->weightPerUnit();
-                    it->stackSize -= remaining;
-                    totalWeight_ -= unitWeight * remaining;
-                    remaining = 0;
-                    break;
-                } else {
-                    totalWeight_ -= it->getWeight();
-                    remaining -= it->stackSize;
-                    it = items_.erase(it);
-                    continue;
-                }
+        auto idx = index_.find(id);
+        if (idx == index_.end() || idx->second.total < quantity)
+            return Result<void>::err("item not found in inventory");
+
+        int remaining = quantity;
+        while (remaining > 0) {
+            // the entry is erased together with its last stack, so re‑resolve it
+            std::size_t slot = index_.find(id)->second.slots.back();
+            int size = slots_[slot].item.stackSize;
+            if (size > remaining) {
+                setStackSize(slot, size - remaining);
+                remaining = 0;
+            } else {
+                remaining -= size;
+                eraseStack(slot);
             }
-            ++it;
         }
-
-        if (remaining > 0)
-            return Result<void>::err("item not found in inventory");
+        checkTotals();
         return Result<void>::ok();
     }
 
-    int count(const std::string& id) const {
-        int sum = 0;
-        for (const auto& it : items_)
-            if (it.id == id) sum += it.stackSize;
-        return sum;
+    int count(const std::string& id) const { return count(ItemIds::find(id)); }
+
+    int count(ItemId id) const {
+        auto idx = index_.find(id);
+        return idx == index_.end() ? 0 : idx->second.total;
+    }
+
+    // handles of every stack of `id`, in the order removeItem takes from
+    // them; stacks of one id may differ in rarity and rolled stats
+    void stacksOf(ItemId id, std::vector<SlotHandle>& out) const {
+        out.clear();
+        auto idx = index_.find(id);
+        if (idx == index_.end()) return;
+        const auto& slots = idx->second.slots;
+        for (auto s = slots.rbegin(); s != slots.rend(); ++s)
+            out.push_back({static_cast<std::uint32_t>(*s), slots_[*s].generation});
     }
 
     // -----------------------------------------------------------------
     //  Accessors for UI / other systems
     // -----------------------------------------------------------------
     int totalWeight() const { return totalWeight_; }
-    size_t usedSlots() const { return items_.size(); }
-    const std::vector<Item>& getItems() const { return items_; }
-    const std::unordered_map<EquipSlot, std::unique_ptr<Item>>& getEquipment() const { return equipped_; }
+    size_t usedSlots() const { return used_; }
+
+    // O(1) running totals, equipped items included (count(id) is bag‑only
+    // because crafting and trades can only consume what is in the bag)
+    const ItemTally& totals(ItemType t) const { return byType_[static_cast<std::size_t>(t)]; }
+    const ItemTally& totals(Rarity r)   const { return byRarity_[static_cast<std::size_t>(r)]; }
+
+    // occupied slots in slot order; iterators also expose the slot handle
+    class ItemRange {
+    public:
+        class iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type        = Item;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = const Item*;
+            using reference         = const Item&;
+
+            iterator(const Slot* base, const Slot* cur, const Slot* end)
+                : base_(base), cur_(cur), end_(end) { skipFree(); }
+
+            reference operator*()  const { return cur_->item; }
+            pointer   operator->() const { return &cur_->item; }
+            iterator& operator++() { ++cur_; skipFree(); return *this; }
+            iterator  operator++(int) { iterator tmp = *this; ++*this; return tmp; }
+            bool operator==(const iterator& o) const { return cur_ == o.cur_; }
+            bool operator!=(const iterator& o) const { return cur_ != o.cur_; }
+
+            SlotHandle handle() const {
+                return {static_cast<std::uint32_t>(cur_ - base_), cur_->generation};
+            }
+
+        private:
+            const Slot* base_;
+            const Slot* cur_;
+            const Slot* end_;
+            void skipFree() { while (cur_ != end_ && !cur_->occupied) ++cur_; }
+        };
+
+        ItemRange(const Slot* b, const Slot* e, std::size_t n) : begin_(b), end_(e), size_(n) {}
+        iterator begin() const { return iterator(begin_, begin_, end_); }
+        iterator end()   const { return iterator(begin_, end_, end_); }
+        std::size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+
+    private:
+        const Slot* begin_;
+        const Slot* end_;
+        std::size_t size_;
+    };
+
+    ItemRange getItems() const {
+        return ItemRange(slots_.data(), slots_.data() + slots_.size(), used_);
+    }
+
+    // -----------------------------------------------------------------
+    //  Slot handles – stable across unrelated adds/removes
+    // -----------------------------------------------------------------
+    const Item* get(SlotHandle h) const {
+        return isLive(h) ? &slots_[h.index].item : nullptr;
+    }
+
+    Result<void> removeAt(SlotHandle h, int quantity = 1) {
+        if (!isLive(h)) return Result<void>::err("stale or invalid slot handle");
+        if (quantity <= 0) return Result<void>::ok();
+        int size = slots_[h.index].item.stackSize;
+        if (quantity > size) return Result<void>::err("not enough items in slot");
+        if (quantity == size) eraseStack(h.index);
+        else                  setStackSize(h.index, size - quantity);
+        checkTotals();
+        return Result<void>::ok();
+    }
+
+    // -----------------------------------------------------------------
+    //  Filtered / sorted views – walk one secondary index and stop at
+    //  q.limit, instead of copying and sorting every slot per frame.
+    //  Unsorted results come back in the order of the index walked.
+    // -----------------------------------------------------------------
+    std::vector<SlotHandle> query(const ItemQuery& q) const {
+        std::vector<SlotHandle> out;
+        query(q, out);
+        return out;
+    }
+
+    // reuses the caller's buffer – no allocation once it has grown
+    void query(const ItemQuery& q, std::vector<SlotHandle>& out) const {
+        out.clear();
+        if (q.limit == 0) return;
+
+        auto emit = [&](std::uint32_t s) {
+            const Item& it = slots_[s].item;
+            if ((!q.type || it.type() == *q.type) &&
+                it.rarity >= q.minRarity && it.rarity <= q.maxRarity &&
+                it.levelReq >= q.minLevelReq && it.levelReq <= q.maxLevelReq)
+                out.push_back({s, slots_[s].generation});
+            return out.size() < q.limit;
+        };
+        auto walk = [&](const KeyIndex& idx, int lo, int hi, bool descending) {
+            if (lo > hi) return;
+            auto first = idx.lower_bound({lo, 0});
+            auto last  = idx.upper_bound({hi, std::numeric_limits<std::uint32_t>::max()});
+            if (!descending) {
+                for (auto it = first; it != last; ++it)
+                    if (!emit(it->second)) return;
+            } else {
+                for (auto it = last; it != first;)
+                    if (!emit((--it)->second)) return;
+            }
+        };
+
+        const int rLo = static_cast<int>(q.minRarity), rHi = static_cast<int>(q.maxRarity);
+        const bool rarityNarrowed = q.minRarity != Rarity::Common || q.maxRarity != Rarity::Legendary;
+        const bool levelNarrowed  = q.minLevelReq != std::numeric_limits<int>::min() ||
+                                    q.maxLevelReq != std::numeric_limits<int>::max();
+
+        if (q.sortBy != ItemSortKey::None) {
+            int lo = std::numeric_limits<int>::min(), hi = std::numeric_limits<int>::max();
+            if (q.sortBy == ItemSortKey::Rarity)   { lo = rLo; hi = rHi; }
+            if (q.sortBy == ItemSortKey::LevelReq) { lo = q.minLevelReq; hi = q.maxLevelReq; }
+            walk(keyIndex_[static_cast<std::size_t>(q.sortBy)], lo, hi, q.descending);
+        } else if (q.type) {
+            for (std::uint32_t s : typeIndex_[static_cast<std::size_t>(*q.type)])
+                if (!emit(s)) return;
+        } else if (rarityNarrowed) {
+            walk(keyIndex_[static_cast<std::size_t>(ItemSortKey::Rarity)], rLo, rHi, false);
+        } else if (levelNarrowed) {
+            walk(keyIndex_[static_cast<std::size_t>(ItemSortKey::LevelReq)],
+                 q.minLevelReq, q.maxLevelReq, false);
+        } else {
+            for (std::size_t s = 0; s < slots_.size(); ++s)
+                if (slots_[s].occupied && !emit(static_cast<std::uint32_t>(s))) return;
+        }
+    }
+
+    using Equipment = std::array<std::optional<Item>, kEquipSlotCount>;
+    const Equipment& getEquipment() const { return equipped_; }
+
+    // kept up to date by equip/unequip/deserialize – no per‑hit recompute
+    const EquipStats& equipmentStats() const { return equipStats_; }
 
     // -----------------------------------------------------------------
     //  Equipment handling
     // -----------------------------------------------------------------
     Result<void> equip(const std::string& id, int playerLevel = 1) {
-        auto it = std::find_if(items_.begin(), items_.end(),
-                               [&](const Item& i){ return i.id == id; });
-        if (it == items_.end())
+        return equip(ItemIds::find(id), playerLevel);
+    }
+
+    Result<void> equip(ItemId id, int playerLevel = 1) {
+        auto idx = index_.find(id);
+        if (idx == index_.end())
             return Result<void>::err("item not in inventory");
+        return equipFrom(idx->second.slots.front(), playerLevel);
+    }
 
-        if (it->levelReq > playerLevel)
+    Result<void> equip(SlotHandle h, int playerLevel = 1) {
+        if (!isLive(h)) return Result<void>::err("stale or invalid slot handle");
+        return equipFrom(h.index, playerLevel);
+    }
+
+private:
+    // slot indices are stable, so `src` survives the addItem that puts the
+    // currently equipped item back into the bag
+    Result<void> equipFrom(std::size_t src, int playerLevel) {
+        ItemId id = slots_[src].item.id();
+        if (slots_[src].item.levelReq > playerLevel)
             return Result<void>::err("your level is too low to equip this item");
 
-        EquipSlot slot = slotForItem(*it);
+        EquipSlot slot = slots_[src].item.slot();
         if (slot == EquipSlot::None)
             return Result<void>::err("item not equipable");
 
         // Unequip current item (if any) back into inventory
-        if (auto* cur = equipped_[slot].get()) {
-            totalWeight_ -= cur->getWeight();
-            auto back = addItem(*cur);
+        std::optional<Item>& cur = equipped_[static_cast<std::size_t>(slot)];
+        if (cur) {
+            account(*cur, -cur->stackSize);
+            auto back = insert(*cur);
             if (!back) {
-                totalWeight_ += cur->getWeight();
+                account(*cur, +cur->stackSize);
                 return Result<void>::err("cannot unequip existing item: " + back.error());
             }
+            accumulateStats(*cur, -1);
         }
 
         // Move one instance (or the whole stack if non‑stackable)
-        if (it->maxStack > 1 && it->stackSize > 1) {
-            Item one = *it;
+        Item& it = slots_[src].item;
+        if (it.maxStack() > 1 && it.stackSize > 1) {
+            Item one = it;
             one.stackSize = 1;
-            int unitWeight = it->weightPerUnit();
-
-            it->stackSize -= 1;
-            totalWeight_ -= unitWeight;
-
-            equipped_[slot] = std::make_unique<Item>(std::move(one));
-            totalWeight_ += unitWeight;
+            setStackSize(src, it.stackSize - 1);
+            cur = std::move(one);
         } else {
-            int itemWeight = it->getWeight();
-            totalWeight_ -= itemWeight;
-            equipped_[slot] = std::make_unique<Item>(std::move(*it));
-            items_.erase(it);
-            totalWeight_ += itemWeight;
+            cur = it;
+            eraseStack(src);
         }
+        account(*cur, +cur->stackSize);
+        accumulateStats(*cur, +1);
+        equipDirty_[static_cast<std::size_t>(slot)] = true;
 
-        Log::info("Equipped '" + id + "' to slot " + toString(slot));
+        Log::info("Equipped '" + ItemIds::name(id) + "' to slot " + toString(slot));
+        checkTotals();
         return Result<void>::ok();
     }
 
+public:
     Result<void> unequip(EquipSlot slot) {
-        auto it = equipped_.find(slot);
-        if (it == equipped_.end() || !it->second)
+        if (slot == EquipSlot::None || !equipped_[static_cast<std::size_t>(slot)])
             return Result<void>::err("slot empty");
+        std::optional<Item>& cur = equipped_[static_cast<std::size_t>(slot)];
 
-        int eqWeight = it->second->getWeight();
-        totalWeight_ -= eqWeight;
-
-        auto back = addItem(*it->second);
+        account(*cur, -cur->stackSize);
+        auto back = insert(*cur);
         if (!back) {
-            totalWeight_ += eqWeight;
+            account(*cur, +cur->stackSize);
             return Result<void>::err("cannot unequip: " + back.error());
         }
 
-        it->second.reset();
+        accumulateStats(*cur, -1);
+        cur.reset();
+        equipDirty_[static_cast<std::size_t>(slot)] = true;
         Log::info("Unequipped slot " + toString(slot));
+        checkTotals();
         return Result<void>::ok();
     }
 
     const Item* getEquipped(EquipSlot slot) const {
-        auto it = equipped_.find(slot);
-        return (it != equipped_.end() && it->second) ? it->second.get() : nullptr;
+        if (slot == EquipSlot::None) return nullptr;
+        const auto& cur = equipped_[static_cast<std::size_t>(slot)];
+        return cur ? &*cur : nullptr;
     }
 
     // -----------------------------------------------------------------
@@ -200,13 +462,22 @@ public:
                        ItemFactory& factory,
                        const CraftingSystem& crafting,
                        int playerLevel = 1) {
-        const Recipe* rec = crafting.get(resultId);
+        const Recipe* rec = crafting.find(resultId);
         if (!rec) return Result<void>::err("no recipe for '" + resultId + "'");
+        return craft(rec->resultId, factory, crafting, playerLevel);
+    }
+
+    Result<void> craft(ItemId resultId,
+                       ItemFactory& factory,
+                       const CraftingSystem& crafting,
+                       int playerLevel = 1) {
+        const Recipe* rec = crafting.find(resultId);
+        if (!rec) return Result<void>::err("no recipe for '" + ItemIds::name(resultId) + "'");
 
         // check ingredient availability
         for (auto& [ingId, qty] : rec->ingredients) {
             if (count(ingId) < qty)
-                return Result<void>::err("missing ingredient '" + ingId + "' (need " + std::to_string(qty) + ")");
+                return Result<void>::err("missing ingredient '" + ItemIds::name(ingId) + "' (need " + std::to_string(qty) + ")");
         }
 
         // create product
@@ -223,27 +494,210 @@ public:
         // consume ingredients
         for (auto& [ingId, qty] : rec->ingredients) {
             auto rem = removeItem(ingId, qty);
-            if (!rem) return Result<void>::err("failed to consume '" + ingId + "': " + rem.error());
+            if (!rem) return Result<void>::err("failed to consume '" + ItemIds::name(ingId) + "': " + rem.error());
         }
 
         // store product
         auto addRes = addItem(product);
         if (!addRes) return Result<void>::err("failed to store crafted item: " + addRes.error());
 
-        Log::info("Crafted '" + resultId + "' x" + std::to_string(product.stackSize));
+        Log::info("Crafted '" + ItemIds::name(resultId) + "' x" + std::to_string(product.stackSize));
         return Result<void>::ok();
     }
 
+    // crafts up to `n` times in one transaction and returns how many
+    // were made: the largest count that fits is worked out first (from
+    // ingredient totals, then against the weight/slot limits), and only
+    // then are that many products rolled – one roll per craft, drawn in
+    // the same order as that many single craft() calls would draw them.
+    // All ingredients are taken and all products stored in one
+    // applyBatch. Fails only if not even one craft is possible.
+    Result<int> craft(const std::string& resultId, int n,
+                      ItemFactory& factory,
+                      const CraftingSystem& crafting,
+                      int playerLevel = 1) {
+        const Recipe* rec = crafting.find(resultId);
+        if (!rec) return Result<int>::err("no recipe for '" + resultId + "'");
+        return craft(rec->resultId, n, factory, crafting, playerLevel);
+    }
+
+    Result<int> craft(ItemId resultId, int n,
+                      ItemFactory& factory,
+                      const CraftingSystem& crafting,
+                      int playerLevel = 1) {
+        const Recipe* rec = crafting.find(resultId);
+        if (!rec) return Result<int>::err("no recipe for '" + ItemIds::name(resultId) + "'");
+        const int perCraft = std::max(1, rec->resultCount);
+
+        // 1) ingredient bound – one count() per ingredient, not per craft
+        int most = std::min(n, std::numeric_limits<int>::max() / perCraft);
+        for (auto& [ingId, qty] : rec->ingredients) {
+            if (qty <= 0) continue;
+            int have = count(ingId);
+            if (have < qty)
+                return Result<int>::err("missing ingredient '" + ItemIds::name(ingId) + "' (need " + std::to_string(qty) + ")");
+            most = std::min(most, have / qty);
+        }
+        if (most <= 0) return Result<int>::err("nothing to craft");
+
+        // 2) capacity – rolls never change weight or stacking, so the bare
+        //    template stands in for every product and nothing is rolled yet
+        const ItemTemplate* tmpl = factory.find(resultId);
+        if (!tmpl)
+            return Result<int>::err("factory failed: Unknown item id '" + ItemIds::name(resultId) + "'");
+        Item proto(*tmpl);
+
+        // weight and slots after k crafts, from the per‑craft deltas:
+        // removals drain each ingredient's stacks back to front (as
+        // planBatch does), so prefix sums over that order give the stacks
+        // emptied and the weight shed; products fill the id's free room,
+        // then whole new stacks
+        struct Drain { int qty; std::vector<long long> units, weight; };
+        std::vector<Drain> drains;
+        for (auto& [ingId, qty] : rec->ingredients) {
+            if (qty <= 0) continue;
+            Drain d{qty, {0}, {0}};
+            const auto& held = index_.find(ingId)->second.slots;    // count() > 0 above
+            for (auto s = held.rbegin(); s != held.rend(); ++s) {
+                const Item& it = slots_[*s].item;
+                d.units.push_back(d.units.back() + it.stackSize);
+                d.weight.push_back(d.weight.back() + static_cast<long long>(it.weightPerUnit()) * it.stackSize);
+            }
+            drains.push_back(std::move(d));
+        }
+        const long long maxStack = std::max(1, proto.maxStack());
+        long long room = 0;
+        if (proto.maxStack() > 1)
+            if (auto idx = index_.find(resultId); idx != index_.end()) room = idx->second.freeSpace;
+        const long long weightCap = std::max<long long>(weightLimit_, totalWeight_);
+        const long long slotCap   = static_cast<long long>(std::max(slotLimit_, used_));
+
+        auto newStacks = [&](int k) {
+            long long over = static_cast<long long>(perCraft) * k - room;
+            return over > 0 ? (over + maxStack - 1) / maxStack : 0;
+        };
+        auto weightAfter = [&](int k) {
+            long long w = totalWeight_ + static_cast<long long>(proto.weightPerUnit()) * perCraft * k;
+            for (const Drain& d : drains) {
+                long long take = static_cast<long long>(d.qty) * k;
+                std::size_t e = std::upper_bound(d.units.begin(), d.units.end(), take) - d.units.begin() - 1;
+                w -= d.weight[e];
+                if (e + 1 < d.units.size())     // part of the next stack
+                    w -= (take - d.units[e]) * ((d.weight[e + 1] - d.weight[e]) / (d.units[e + 1] - d.units[e]));
+            }
+            return w;
+        };
+        auto slotsAfter = [&](int k) {
+            long long used = static_cast<long long>(used_) + newStacks(k);
+            for (const Drain& d : drains)
+                used -= std::upper_bound(d.units.begin(), d.units.end(), static_cast<long long>(d.qty) * k) -
+                        d.units.begin() - 1;
+            return used;
+        };
+
+        // a product that is also an ingredient refills its own emptied
+        // stacks, which this doesn't model: such recipes only get the
+        // weight bound and are left to planBatch below
+        const bool selfFed = std::any_of(rec->ingredients.begin(), rec->ingredients.end(),
+                                         [&](const auto& ing) { return ing.first == resultId; });
+        // every ingredient stack is already counted in used_, so no count
+        // needing more than slotCap new stacks can fit
+        if (!selfFed)
+            most = static_cast<int>(std::min<long long>(most, (room + slotCap * maxStack) / perCraft));
+        // weight is linear in k: bisect for the last count under the cap
+        int lo = 0, hi = most + 1;
+        while (hi - lo > 1) {
+            int mid = lo + (hi - lo) / 2;
+            (weightAfter(mid) <= weightCap ? lo : hi) = mid;
+        }
+        // slots aren't monotone – removals free room, so k crafts may fit
+        // where k‑1 don't. Within a run of counts needing the same number
+        // of new product stacks, more crafts only empty more ingredient
+        // stacks, so only the top of each run is worth trying
+        int crafted = lo;
+        while (!selfFed && crafted > 0 && slotsAfter(crafted) > slotCap) {
+            long long m = newStacks(crafted);
+            crafted = m == 0 ? 0 : static_cast<int>((room + (m - 1) * maxStack) / perCraft);
+        }
+
+        std::vector<InventoryOp> ops;
+        auto fits = [&](int k) {
+            ops.clear();
+            for (auto& [ingId, qty] : rec->ingredients) ops.push_back(InventoryOp::remove(ingId, qty * k));
+            proto.stackSize = perCraft * k;
+            ops.push_back(InventoryOp::add(proto));
+            batchScratch_.reset();
+            return static_cast<bool>(planBatch(ops, batchScratch_));
+        };
+        // one plan confirms the count (self‑fed recipes step down from the
+        // weight bound until one fits)
+        while (crafted > 0 && !fits(crafted)) --crafted;
+        if (crafted == 0) return Result<int>::err("no space/weight for crafted item");
+
+        // 3) products – one roll per craft; consecutive identical rolls
+        //    share one op
+        ops.pop_back();
+        const std::size_t removals = ops.size();
+        for (int i = 0; i < crafted; ++i) {
+            auto prodRes = factory.create(resultId, playerLevel);
+            if (!prodRes) return Result<int>::err("factory failed: " + prodRes.error());
+            Item& product = prodRes.value();
+            if (ops.size() > removals && sameRoll(ops.back().item, product)) {
+                ops.back().item.stackSize += perCraft;
+                continue;
+            }
+            product.stackSize = perCraft;
+            ops.push_back(InventoryOp::add(std::move(product)));
+        }
+
+        // 4) one pass over ingredients and products
+        auto res = applyBatch(ops);
+        if (!res) return Result<int>::err("failed to craft: " + res.error());
+
+        Log::info("Crafted '" + ItemIds::name(resultId) + "' x" + std::to_string(crafted * perCraft) +
+                  " (" + std::to_string(crafted) + " crafts)");
+        return Result<int>::ok(crafted);
+    }
+
+    // keeps craftable() up to date from now on; counts changed by
+    // add/remove re‑check only the recipes that use the changed id
+    void trackCraftable(const CraftingSystem& crafting) {
+        craftable_.attach(crafting, [this](ItemId id) { return count(id); });
+    }
+
+    // result ids of every recipe whose ingredients are all in the bag
+    // (empty unless trackCraftable() was called); picks up reloads
+    const std::vector<ItemId>& craftable() const {
+        craftable_.refresh([this](ItemId id) { return count(id); });
+        return craftable_.items();
+    }
+    bool canCraft(ItemId resultId) const {
+        craftable_.refresh([this](ItemId id) { return count(id); });
+        return craftable_.contains(resultId);
+    }
+
     // -----------------------------------------------------------------
     //  Persistence (save / load)
     // -----------------------------------------------------------------
+    // full save; every item records its slot index so deltas written
+    // later can address the same slots
     std::string serialize() const {
         json j;
-        j["items"] = items_;
+        json_array items;
+        items.reserve(used_);
+        const ItemRange range = getItems();
+        for (auto it = range.begin(); it != range.end(); ++it) {
+            json elem;
+            to_json(elem, *it);
+            elem["index"] = static_cast<int>(it.handle().index);
+            items.emplace_back(std::move(elem));
+        }
+        j["items"] = json(std::move(items));
         json eq;
-        for (const auto& [slot, ptr] : equipped_) {
-            if (ptr) eq[toString(slot)] = *ptr;
-            else    eq[toString(slot)] = nullptr;
+        for (std::size_t i = 0; i < kEquipSlotCount; ++i) {
+            const std::string key = toString(static_cast<EquipSlot>(i));
+            if (equipped_[i]) eq[key] = *equipped_[i];
+            else              eq[key] = json(nullptr);
         }
         j["equipment"] = eq;
         return j.dump(4);
@@ -254,112 +708,811 @@ public:
         try { j = json::parse(data); }
         catch (const std::exception& e) { return Result<void>::err("JSON parse error: " + std::string(e.what())); }
 
-        items_.clear();
-        equipped_.clear();
+        // handles taken before the load must stay stale, so slots created
+        // from here on start above every generation handed out so far
+        for (const Slot& slot : slots_) genBase_ = std::max(genBase_, slot.generation + 1);
+        slots_.clear();
+        freeSlots_.clear();
+        dirtySlots_.clear();
+        used_ = 0;
+        index_.clear();
+        for (auto& t : typeIndex_) t.clear();
+        for (auto& k : keyIndex_)  k.clear();
+        for (auto& e : equipped_) e.reset();
+        equipStats_ = EquipStats{};
         totalWeight_ = 0;
+        byType_ = {};
+        byRarity_ = {};
+        craftable_.recount([](ItemId) { return 0; });
 
         if (!j.contains("items") || !j["items"].is_array())
             return Result<void>::err("missing or invalid 'items' array");
 
+        // saves written before slot indices were recorded load in order
+        const std::size_t maxIndex = slotLimit_ + j["items"].size();
         for (const auto& elem : j["items"]) {
             try {
-                Item it = elem.get<Item>();
-                items_.push_back(it);
-                totalWeight_ += it.getWeight();
+                Item item = elem.get<Item>();
+                int at = elem.contains("index") ? elem["index"].get<int>() : -1;
+                if (at >= 0 && static_cast<std::size_t>(at) < maxIndex)
+                    placeStack(static_cast<std::size_t>(at), std::move(item));
+                else
+                    pushStack(std::move(item));
             } catch (const std::exception& e) {
                 Log::warn("Failed to load item: " + std::string(e.what()));
             }
         }
 
-        if (j.contains("equipment") && j["equipment"].is_object()) {
-            const json& eq = j["equipment"];
-            for (auto it = eq.object_begin(); it != eq.object_end(); ++it) {
-                const std::string& slotStr = it.key();
-                EquipSlot slot = EquipSlot::None;
-                if (slotStr == "Head")       slot = EquipSlot::Head;
-                else if (slotStr == "Chest") slot = EquipSlot::Chest;
-                else if (slotStr == "Legs")  slot = EquipSlot::Legs;
-                else if (slotStr == "Weapon")slot = EquipSlot::Weapon;
-                else if (slotStr == "Shield")slot = EquipSlot::Shield;
-                else if (slotStr == "Accessory") slot = EquipSlot::Accessory;
-
-                if (slot == EquipSlot::None) continue;
-
-                if (!it.value().is_null()) {
-                    try {
-                        Item eqItem = it.value().get<Item>();
-                        equipped_[slot] = std::make_unique<Item>(eqItem);
-                        totalWeight_ += eqItem.getWeight();
-                    } catch (const std::exception& e) {
-                        Log::warn("Failed to load equipped item for " + slotStr + ": " + std::string(e.what()));
-                    }
-                }
-            }
-        }
+        if (j.contains("equipment") && j["equipment"].is_object())
+            loadEquipment(j["equipment"]);
 
-        if (items_.size() > slotLimit_)
-            Log::warn("Loaded inventory exceeds slot limit (" + std::to_string(items_.size()) +
+        if (used_ > slotLimit_)
+            Log::warn("Loaded inventory exceeds slot limit (" + std::to_string(used_) +
                       " > " + std::to_string(slotLimit_) + ").");
         if (totalWeight_ > weightLimit_)
             Log::warn("Loaded inventory exceeds weight limit (" + std::to_string(totalWeight_) +
                       " > " + std::to_string(weightLimit_) + ").");
 
+        checkpoint();
+        checkTotals();
+        return Result<void>::ok();
+    }
+
+    // -----------------------------------------------------------------
+    //  Incremental saves – checkpoint() marks the current state as saved;
+    //  serializeDelta() then writes only the slots and equipment entries
+    //  touched since, as compact JSON. load() replays base + deltas.
+    // -----------------------------------------------------------------
+    bool hasUnsavedChanges() const {
+        return !dirtySlots_.empty() ||
+               std::any_of(equipDirty_.begin(), equipDirty_.end(), [](bool d) { return d; });
+    }
+
+    void checkpoint() {
+        for (std::uint32_t s : dirtySlots_) slots_[s].dirty = false;
+        dirtySlots_.clear();
+        equipDirty_.fill(false);
+    }
+
+    std::string serializeDelta() const {
+        json_array changed;
+        changed.reserve(dirtySlots_.size());
+        for (std::uint32_t s : dirtySlots_) {
+            json elem;
+            elem["index"] = static_cast<int>(s);
+            if (slots_[s].occupied) elem["item"] = slots_[s].item;
+            else                    elem["item"] = json(nullptr);
+            changed.emplace_back(std::move(elem));
+        }
+        json eq = json(json_object{});
+        for (std::size_t i = 0; i < kEquipSlotCount; ++i) {
+            if (!equipDirty_[i]) continue;
+            const std::string key = toString(static_cast<EquipSlot>(i));
+            if (equipped_[i]) eq[key] = *equipped_[i];
+            else              eq[key] = json(nullptr);
+        }
+        json j;
+        j["slots"] = json(std::move(changed));
+        j["equipment"] = eq;
+        return j.dump();
+    }
+
+    Result<void> applyDelta(const std::string& data) {
+        json j;
+        try { j = json::parse(data); }
+        catch (const std::exception& e) { return Result<void>::err("JSON parse error: " + std::string(e.what())); }
+
+        if (!j.contains("slots") || !j["slots"].is_array())
+            return Result<void>::err("missing or invalid 'slots' array");
+
+        const std::size_t maxIndex = std::max(slots_.size(), slotLimit_) + j["slots"].size();
+        for (const auto& elem : j["slots"]) {
+            try {
+                int at = elem.at("index").get<int>();
+                if (at < 0 || static_cast<std::size_t>(at) >= maxIndex)
+                    throw std::out_of_range("slot index " + std::to_string(at) + " out of range");
+                std::size_t slot = static_cast<std::size_t>(at);
+                const json& item = elem.at("item");
+                if (!item.is_null())
+                    placeStack(slot, item.get<Item>());
+                else if (slot < slots_.size() && slots_[slot].occupied)
+                    eraseStack(slot);
+            } catch (const std::exception& e) {
+                Log::warn("Failed to apply slot delta: " + std::string(e.what()));
+            }
+        }
+
+        if (j.contains("equipment") && j["equipment"].is_object())
+            loadEquipment(j["equipment"]);
+
+        checkTotals();
+        return Result<void>::ok();
+    }
+
+    // base save followed by its deltas, oldest first; leaves a clean checkpoint
+    Result<void> load(const std::string& base, const std::vector<std::string>& deltas) {
+        auto res = deserialize(base);
+        if (!res) return res;
+        for (std::size_t i = 0; i < deltas.size(); ++i) {
+            auto d = applyDelta(deltas[i]);
+            if (!d) return Result<void>::err("delta " + std::to_string(i) + ": " + d.error());
+        }
+        checkpoint();
         return Result<void>::ok();
     }
 
     // -----------------------------------------------------------------
     //  Helper used by crafting – does the item *fit* into the inventory?
     // -----------------------------------------------------------------
+    // With auto‑compaction on it answers for the bag as addItem would
+    // leave it after merging partial stacks.
     Result<void> canAdd(const Item& item) const {
         if (totalWeight_ + item.getWeight() > weightLimit_)
             return Result<void>::err("weight limit would be exceeded");
 
-        std::size_t neededSlots = 0;
-        if (item.maxStack > 1) {
-            int remaining = item.stackSize;
-            for (const auto& existing : items_) {
-                if (existing.id == item.id && existing.stackSize < existing.maxStack) {
-                    int freeSpace = existing.maxStack - existing.stackSize;
-                    int use = std::min(freeSpace, remaining);
-                    remaining -= use;
-                    if (remaining == 0) break;
-                }
-            }
-            if (remaining > 0)
-                neededSlots = static_cast<std::size_t>((remaining + item.maxStack - 1) / item.maxStack);
-        } else {
-            neededSlots = static_cast<std::size_t>(item.stackSize);
-        }
-
-        if (items_.size() + neededSlots > slotLimit_)
+        if (used_ + slotsNeeded(item) > slotLimit_ &&
+            (!autoCompact_ || used_ - mergeableSlots() + slotsNeededAfterMerge(item) > slotLimit_))
             return Result<void>::err("no free inventory slot for the item");
 
         return Result<void>::ok();
     }
 
+    // -----------------------------------------------------------------
+    //  Batch transactions – all ops commit together or none do
+    // -----------------------------------------------------------------
+    // Ops run in order (a Remove may consume units added earlier in the
+    // same batch; a RemoveAt only ever takes from the stack its handle
+    // named when the batch started). Weight and slot limits are checked
+    // once against the final state, so intermediate overshoot inside a
+    // batch is allowed.
+    Result<void> applyBatch(const std::vector<InventoryOp>& ops) {
+        batchScratch_.reset();
+        auto ok = planBatch(ops, batchScratch_);
+        if (!ok) return ok;
+        commitBatch(batchScratch_);
+        checkTotals();
+        return Result<void>::ok();
+    }
+
+    Result<void> canApplyBatch(const std::vector<InventoryOp>& ops) const {
+        BatchPlan plan;
+        return planBatch(ops, plan);
+    }
+
+    // -----------------------------------------------------------------
+    //  Compaction – merges partial stacks of the same id, then optionally
+    //  sorts the bag into canonical order (type, rarity high→low, name,
+    //  larger stacks first) with occupied slots packed at the front.
+    //  Works in place on slots_; handles to merged or moved stacks go
+    //  stale. Returns the number of slots freed.
+    // -----------------------------------------------------------------
+    std::size_t compact(bool canonicalOrder = false) {
+        std::size_t before = used_;
+        mergePartials();
+        if (canonicalOrder) sortSlots();
+        checkTotals();
+        return before - used_;
+    }
+
+    // when on, addItem compacts once before reporting "slot limit reached"
+    void setAutoCompact(bool on) { autoCompact_ = on; }
+    bool autoCompact() const { return autoCompact_; }
+
+    // -----------------------------------------------------------------
+    //  Consistency check – recomputes every cached total from scratch.
+    //  Builds with RPG_INVENTORY_VERIFY run it after each mutation.
+    // -----------------------------------------------------------------
+    Result<void> verifyTotals() const {
+        int weight = 0;
+        std::size_t used = 0;
+        std::array<ItemTally, kItemTypeCount> byType{};
+        std::array<ItemTally, kRarityCount>   byRarity{};
+        std::unordered_map<ItemId, StackIndex> index;
+
+        auto tally = [&](const Item& it) {
+            int w = payloadWeight(it.data) * it.stackSize;  // not the cached unitWeight
+            weight += w;
+            byType[static_cast<std::size_t>(it.type())].count    += it.stackSize;
+            byType[static_cast<std::size_t>(it.type())].weight   += w;
+            byRarity[static_cast<std::size_t>(it.rarity)].count  += it.stackSize;
+            byRarity[static_cast<std::size_t>(it.rarity)].weight += w;
+        };
+        for (std::size_t i = 0; i < slots_.size(); ++i) {
+            if (!slots_[i].occupied) continue;
+            const Item& it = slots_[i].item;
+            tally(it);
+            ++used;
+            StackIndex& idx = index[it.id()];
+            idx.slots.push_back(i);
+            idx.total += it.stackSize;
+            if (roomLeft(it) > 0) { idx.partial.push_back(i); idx.freeSpace += roomLeft(it); }
+        }
+        for (const auto& e : equipped_)
+            if (e) tally(*e);
+
+        if (used != used_ || used + freeSlots_.size() != slots_.size())
+            return Result<void>::err("used slot count drifted");
+        if (weight != totalWeight_)
+            return Result<void>::err("total weight drifted (" + std::to_string(totalWeight_) +
+                                     " cached, " + std::to_string(weight) + " actual)");
+        for (std::size_t t = 0; t < kItemTypeCount; ++t)
+            if (byType[t].count != byType_[t].count || byType[t].weight != byType_[t].weight)
+                return Result<void>::err("totals for type " + toString(static_cast<ItemType>(t)) + " drifted");
+        for (std::size_t r = 0; r < kRarityCount; ++r)
+            if (byRarity[r].count != byRarity_[r].count || byRarity[r].weight != byRarity_[r].weight)
+                return Result<void>::err("totals for rarity " + toString(static_cast<Rarity>(r)) + " drifted");
+        if (index.size() != index_.size())
+            return Result<void>::err("stack index holds stale ids");
+        std::size_t typed = 0;
+        for (const auto& t : typeIndex_) typed += t.size();
+        if (typed != used ||
+            keyIndex_[static_cast<std::size_t>(ItemSortKey::Rarity)].size()   != used ||
+            keyIndex_[static_cast<std::size_t>(ItemSortKey::LevelReq)].size() != used)
+            return Result<void>::err("query indexes out of sync with slots");
+        for (const auto& [id, want] : index) {
+            auto have = index_.find(id);
+            if (have == index_.end() || have->second.total != want.total ||
+                have->second.freeSpace != want.freeSpace ||
+                have->second.slots.size() != want.slots.size() ||
+                have->second.partial.size() != want.partial.size())
+                return Result<void>::err("stack index for '" + ItemIds::name(id) + "' drifted");
+        }
+        if (craftable_.attached()) {
+            CraftableSet fresh = craftable_;
+            fresh.recount([this](ItemId id) { return count(id); });
+            std::vector<ItemId> want = fresh.items(), have = craftable_.items();
+            auto byValue = [](ItemId a, ItemId b) { return a.value < b.value; };
+            std::sort(want.begin(), want.end(), byValue);
+            std::sort(have.begin(), have.end(), byValue);
+            if (want != have) return Result<void>::err("craftable set drifted");
+        }
+        return Result<void>::ok();
+    }
+
 private:
     std::size_t slotLimit_;
     int weightLimit_;
     int totalWeight_{0};
 
-    std::vector<Item> items_;
-    std::unordered_map<EquipSlot, std::unique_ptr<Item>> equipped_;
-
-    static EquipSlot slotForItem(const Item& it) {
-        if (it.type == ItemType::Weapon)      return EquipSlot::Weapon;
-        if (it.type == ItemType::Armor) {
-            const std::string& id = it.id;
-            if (id.find("helmet") != std::string::npos ||
-                id.find("head")   != std::string::npos) return EquipSlot::Head;
-            if (id.find("chest")  != std::string::npos ||
-                id.find("armor")  != std::string::npos) return EquipSlot::Chest;
-            if (id.find("leg")    != std::string::npos ||
-                id.find("boots")  != std::string::npos) return EquipSlot::Legs;
-            return EquipSlot::Chest;
-        }
-        if (it.id.find("shield") != std::string::npos) return EquipSlot::Shield;
-        if (it.id.find("ring")   != std::string::npos ||
-            it.id.find("amulet") != std::string::npos) return EquipSlot::Accessory;
-        return EquipSlot::None;
+    std::vector<Slot> slots_;                   // occupied + free slots, index‑stable
+    std::vector<std::uint32_t> freeSlots_;      // LIFO free‑list into slots_
+    std::size_t used_{0};
+    std::uint32_t genBase_{0};                  // generation of newly created slots (raised by deserialize)
+    bool autoCompact_{false};
+    Equipment equipped_;                        // indexed by EquipSlot
+    EquipStats equipStats_;
+    std::vector<std::uint32_t> dirtySlots_;     // slots with Slot::dirty set
+    std::array<bool, kEquipSlotCount> equipDirty_{};
+    std::array<ItemTally, kItemTypeCount> byType_{};
+    std::array<ItemTally, kRarityCount>   byRarity_{};
+    mutable CraftableSet craftable_;            // fed by fillSlot/setStackSize/eraseStack
+
+    // every unit entering or leaving the bag/equipment passes through here
+    void account(const Item& it, int units) {
+        if (units == 0) return;
+        int w = it.weightPerUnit() * units;
+        totalWeight_ += w;
+        ItemTally& t = byType_[static_cast<std::size_t>(it.type())];
+        ItemTally& r = byRarity_[static_cast<std::size_t>(it.rarity)];
+        t.count += units;
+        t.weight += w;
+        r.count += units;
+        r.weight += w;
+    }
+
+    void markDirty(std::size_t slot) {
+        if (slots_[slot].dirty) return;
+        slots_[slot].dirty = true;
+        dirtySlots_.push_back(static_cast<std::uint32_t>(slot));
+    }
+
+    // replaces every equipment entry named in `eq` (null clears the slot)
+    void loadEquipment(const json& eq) {
+        for (auto it = eq.object_begin(); it != eq.object_end(); ++it) {
+            const std::string& slotStr = it.key();
+            EquipSlot slot = stringToEquipSlot(slotStr);
+            if (slot == EquipSlot::None) continue;
+
+            std::optional<Item> next;
+            if (!it.value().is_null()) {
+                try {
+                    next = it.value().get<Item>();
+                } catch (const std::exception& e) {
+                    Log::warn("Failed to load equipped item for " + slotStr + ": " + std::string(e.what()));
+                    continue;
+                }
+            }
+
+            std::optional<Item>& cur = equipped_[static_cast<std::size_t>(slot)];
+            if (cur) {
+                account(*cur, -cur->stackSize);
+                accumulateStats(*cur, -1);
+            }
+            cur = std::move(next);
+            if (cur) {
+                account(*cur, +cur->stackSize);
+                accumulateStats(*cur, +1);
+            }
+            equipDirty_[static_cast<std::size_t>(slot)] = true;
+        }
+    }
+
+    void checkTotals() const {
+#ifdef RPG_INVENTORY_VERIFY
+        auto ok = verifyTotals();
+        if (!ok) Log::error("Inventory totals out of sync: " + ok.error());
+        assert(ok && "inventory totals out of sync");
+#endif
+    }
+
+    void accumulateStats(const Item& it, int sign) {
+        equipStats_.weight += sign * it.getWeight();
+        std::visit([&](const auto& d) {
+            using T = std::decay_t<decltype(d)>;
+            if constexpr (std::is_same_v<T, WeaponData>)     equipStats_.damage  += sign * d.damage;
+            else if constexpr (std::is_same_v<T, ArmorData>) equipStats_.defense += sign * d.defense;
+        }, it.data);
+    }
+
+    // -----------------------------------------------------------------
+    //  Per‑id stack index – keeps add/remove/count/canAdd independent of
+    //  the number of occupied slots. Every change to slots_ goes through
+    //  pushStack / setStackSize / eraseStack so the index never drifts.
+    // -----------------------------------------------------------------
+    struct StackIndex {
+        std::vector<std::size_t> slots;     // every slot holding this id
+        std::vector<std::size_t> partial;   // subset of slots with room left
+        int total{0};                       // sum of stackSize over slots
+        int freeSpace{0};                   // sum of free room over partial
+    };
+
+    std::unordered_map<ItemId, StackIndex> index_;
+
+    // -----------------------------------------------------------------
+    //  Secondary indexes for query(). They key on attributes that never
+    //  change while a stack lives, so only pushStack/eraseStack touch them.
+    // -----------------------------------------------------------------
+    using KeyIndex = std::set<std::pair<int, std::uint32_t>>;     // (key, slot)
+
+    std::array<std::set<std::uint32_t>, kItemTypeCount> typeIndex_;
+    std::array<KeyIndex, kItemSortKeyCount> keyIndex_;
+
+    static std::optional<int> sortKeyOf(const Item& it, ItemSortKey key) {
+        switch (key) {
+            case ItemSortKey::LevelReq: return it.levelReq;
+            case ItemSortKey::Rarity:   return static_cast<int>(it.rarity);
+            case ItemSortKey::Damage:
+                if (auto* w = std::get_if<WeaponData>(&it.data)) return w->damage;
+                break;
+            case ItemSortKey::Defense:
+                if (auto* a = std::get_if<ArmorData>(&it.data)) return a->defense;
+                break;
+            case ItemSortKey::HealAmount:
+                if (auto* c = std::get_if<ConsumableData>(&it.data)) return c->healAmount;
+                break;
+            default: break;
+        }
+        return std::nullopt;
+    }
+
+    void indexInsert(std::size_t slot) {
+        const Item& it = slots_[slot].item;
+        auto s = static_cast<std::uint32_t>(slot);
+        typeIndex_[static_cast<std::size_t>(it.type())].insert(s);
+        for (std::size_t k = 0; k < kItemSortKeyCount; ++k)
+            if (auto v = sortKeyOf(it, static_cast<ItemSortKey>(k))) keyIndex_[k].emplace(*v, s);
+    }
+    void indexErase(std::size_t slot) {
+        const Item& it = slots_[slot].item;
+        auto s = static_cast<std::uint32_t>(slot);
+        typeIndex_[static_cast<std::size_t>(it.type())].erase(s);
+        for (std::size_t k = 0; k < kItemSortKeyCount; ++k)
+            if (auto v = sortKeyOf(it, static_cast<ItemSortKey>(k))) keyIndex_[k].erase({*v, s});
+    }
+
+    static int roomLeft(const Item& it) { return std::max(0, it.maxStack() - it.stackSize); }
+
+    // same template and same rolls (stack size aside)
+    static bool sameRoll(const Item& a, const Item& b) {
+        return a.tmpl == b.tmpl && a.rarity == b.rarity && a.levelReq == b.levelReq && a.data == b.data;
+    }
+
+    // slots a new stack of `item` would occupy after topping up partial stacks
+    std::size_t slotsNeeded(const Item& item) const {
+        if (item.maxStack() <= 1)
+            return static_cast<std::size_t>(item.stackSize);
+        auto idx = index_.find(item.id());
+        int remaining = item.stackSize - (idx == index_.end() ? 0 : idx->second.freeSpace);
+        if (remaining <= 0) return 0;
+        return static_cast<std::size_t>((remaining + item.maxStack() - 1) / item.maxStack());
+    }
+
+    // what mergePartials() would do, without doing it: an id's partial
+    // stacks end up as ceil(units / maxStack) stacks, at most one partial
+    static int partialUnits(const StackIndex& idx, int maxStack) {
+        return static_cast<int>(idx.partial.size()) * maxStack - idx.freeSpace;
+    }
+
+    std::size_t mergeableSlots() const {
+        std::size_t freed = 0;
+        for (const auto& entry : index_) {
+            const StackIndex& idx = entry.second;
+            if (idx.partial.size() < 2) continue;
+            int maxStack = slots_[idx.partial.front()].item.maxStack();
+            int units = partialUnits(idx, maxStack);
+            freed += idx.partial.size() - static_cast<std::size_t>((units + maxStack - 1) / maxStack);
+        }
+        return freed;
+    }
+
+    std::size_t slotsNeededAfterMerge(const Item& item) const {
+        if (item.maxStack() <= 1)
+            return static_cast<std::size_t>(item.stackSize);
+        int room = 0;
+        auto idx = index_.find(item.id());
+        if (idx != index_.end() && !idx->second.partial.empty()) {
+            int left = partialUnits(idx->second, item.maxStack()) % item.maxStack();
+            room = left == 0 ? 0 : item.maxStack() - left;
+        }
+        int remaining = item.stackSize - room;
+        if (remaining <= 0) return 0;
+        return static_cast<std::size_t>((remaining + item.maxStack() - 1) / item.maxStack());
+    }
+
+    void linkPartial(StackIndex& idx, std::size_t slot) {
+        slots_[slot].inPartial = idx.partial.size();
+        idx.partial.push_back(slot);
+        idx.freeSpace += roomLeft(slots_[slot].item);
+    }
+    void unlinkPartial(StackIndex& idx, std::size_t slot) {
+        std::size_t pos = slots_[slot].inPartial;
+        idx.freeSpace -= roomLeft(slots_[slot].item);
+        idx.partial[pos] = idx.partial.back();
+        slots_[idx.partial[pos]].inPartial = pos;
+        idx.partial.pop_back();
+        slots_[slot].inPartial = npos;
+    }
+
+    std::size_t pushStack(Item item) {
+        std::size_t slot;
+        if (!freeSlots_.empty()) {
+            slot = freeSlots_.back();
+            freeSlots_.pop_back();
+        } else {
+            slot = slots_.size();
+            growSlots(slot + 1);
+        }
+        fillSlot(slot, std::move(item));
+        return slot;
+    }
+
+    void growSlots(std::size_t n) {
+        std::size_t from = slots_.size();
+        slots_.resize(n);
+        for (std::size_t i = from; i < n; ++i) slots_[i].generation = genBase_;
+    }
+
+    // loaders only: puts a stack at the slot index recorded in a save,
+    // replacing whatever is there
+    void placeStack(std::size_t slot, Item item) {
+        if (slot >= slots_.size()) {
+            for (std::size_t i = slots_.size(); i < slot; ++i)
+                freeSlots_.push_back(static_cast<std::uint32_t>(i));
+            growSlots(slot + 1);
+        } else {
+            if (slots_[slot].occupied) eraseStack(slot);
+            auto f = std::find(freeSlots_.begin(), freeSlots_.end(), static_cast<std::uint32_t>(slot));
+            *f = freeSlots_.back();
+            freeSlots_.pop_back();
+        }
+        fillSlot(slot, std::move(item));
+    }
+
+    void fillSlot(std::size_t slot, Item item) {
+        Slot& s = slots_[slot];
+        s.item = std::move(item);
+        s.occupied = true;
+        ++used_;
+        account(s.item, s.item.stackSize);
+
+        StackIndex& idx = index_[s.item.id()];
+        s.inSlots = idx.slots.size();
+        idx.slots.push_back(slot);
+        craftable_.update(s.item.id(), idx.total, idx.total + s.item.stackSize);
+        idx.total += s.item.stackSize;
+        if (roomLeft(s.item) > 0) linkPartial(idx, slot);
+        indexInsert(slot);
+        markDirty(slot);
+    }
+
+    void setStackSize(std::size_t slot, int newSize) {
+        markDirty(slot);
+        Item& it = slots_[slot].item;
+        StackIndex& idx = index_.find(it.id())->second;
+        bool wasPartial = slots_[slot].inPartial != npos;
+        if (wasPartial) idx.freeSpace -= roomLeft(it);
+
+        account(it, newSize - it.stackSize);
+        craftable_.update(it.id(), idx.total, idx.total + newSize - it.stackSize);
+        idx.total += newSize - it.stackSize;
+        it.stackSize = newSize;
+
+        if (wasPartial) idx.freeSpace += roomLeft(it);
+        bool isPartial = roomLeft(it) > 0;
+        if (isPartial && !wasPartial)      linkPartial(idx, slot);
+        else if (!isPartial && wasPartial) unlinkPartial(idx, slot);
+    }
+
+    // -----------------------------------------------------------------
+    //  Batch planning – simulates the ops on copies of the touched ids'
+    //  stack sizes only, so the cost is independent of inventory size
+    // -----------------------------------------------------------------
+    struct PlanStack {
+        std::size_t slot;           // existing slot, or npos for a new stack
+        int size;
+        int maxStack;
+        int unitWeight;
+        const Item* proto;          // template for new stacks
+    };
+    struct IdPlan {
+        ItemId id;
+        std::vector<PlanStack> stacks;
+    };
+    // keeps its buffers between batches so steady‑state batches don't allocate
+    struct BatchPlan {
+        std::vector<IdPlan> ids;
+        std::vector<std::size_t> emptied;
+        std::size_t used{0};
+
+        void reset() { used = 0; emptied.clear(); }
+        IdPlan* begin() { return ids.data(); }
+        IdPlan* end()   { return ids.data() + used; }
+        IdPlan& next() {
+            if (used == ids.size()) ids.emplace_back();
+            IdPlan& p = ids[used++];
+            p.stacks.clear();
+            return p;
+        }
+    };
+    BatchPlan batchScratch_;
+
+    IdPlan& planFor(BatchPlan& plan, ItemId id) const {
+        for (auto& p : plan)
+            if (p.id == id) return p;
+        IdPlan& p = plan.next();
+        p.id = id;
+        auto idx = index_.find(id);
+        if (idx != index_.end()) {
+            p.stacks.reserve(idx->second.slots.size());
+            for (std::size_t slot : idx->second.slots) {
+                const Item& it = slots_[slot].item;
+                p.stacks.push_back({slot, it.stackSize, it.maxStack(), it.weightPerUnit(), nullptr});
+            }
+        }
+        return p;
+    }
+
+    Result<void> planBatch(const std::vector<InventoryOp>& ops, BatchPlan& plan) const {
+        long long weight = totalWeight_;
+        long long slots  = static_cast<long long>(used_);
+
+        for (std::size_t i = 0; i < ops.size(); ++i) {
+            const InventoryOp& op = ops[i];
+            if (op.kind == InventoryOp::Kind::Add) {
+                const Item& item = op.item;
+                if (item.stackSize <= 0) continue;
+                IdPlan& p = planFor(plan, item.id());
+                int remaining = item.stackSize;
+                int unit = item.weightPerUnit();
+                if (item.maxStack() > 1) {
+                    for (auto& st : p.stacks) {
+                        if (remaining == 0) break;
+                        int room = st.maxStack - st.size;
+                        if (room <= 0 || (st.size == 0 && st.slot == npos)) continue;
+                        int transfer = std::min(room, remaining);
+                        if (st.size == 0) ++slots;      // revived an emptied slot
+                        st.size += transfer;
+                        remaining -= transfer;
+                    }
+                }
+                while (remaining > 0) {
+                    int size = std::min(remaining, std::max(1, item.maxStack()));
+                    p.stacks.push_back({npos, size, item.maxStack(), unit, &item});
+                    remaining -= size;
+                    ++slots;
+                }
+                weight += static_cast<long long>(unit) * item.stackSize;
+            } else if (op.kind == InventoryOp::Kind::RemoveAt) {
+                if (op.quantity <= 0) continue;
+                if (!isLive(op.slot))
+                    return Result<void>::err("batch op " + std::to_string(i) + ": stale or invalid slot handle");
+                IdPlan& p = planFor(plan, slots_[op.slot.index].item.id());
+                auto st = std::find_if(p.stacks.begin(), p.stacks.end(),
+                                       [&](const PlanStack& ps) { return ps.slot == op.slot.index; });
+                if (st->size < op.quantity)
+                    return Result<void>::err("batch op " + std::to_string(i) + ": not enough items in slot");
+                st->size -= op.quantity;
+                weight -= static_cast<long long>(st->unitWeight) * op.quantity;
+                if (st->size == 0) --slots;
+            } else {
+                if (op.quantity <= 0) continue;
+                IdPlan& p = planFor(plan, op.id);
+                int available = 0;
+                for (const auto& st : p.stacks) available += st.size;
+                if (available < op.quantity)
+                    return Result<void>::err("batch op " + std::to_string(i) + ": '" +
+                                             ItemIds::name(op.id) + "' not found in inventory");
+                int remaining = op.quantity;
+                for (auto st = p.stacks.rbegin(); remaining > 0; ++st) {
+                    if (st->size == 0) continue;
+                    int take = std::min(st->size, remaining);
+                    st->size -= take;
+                    remaining -= take;
+                    weight -= static_cast<long long>(st->unitWeight) * take;
+                    if (st->size == 0) --slots;
+                }
+            }
+        }
+
+        // an inventory loaded over its limits may still shed items; only
+        // a batch that ends above both the limit and where it started fails
+        if (weight > std::max<long long>(weightLimit_, totalWeight_))
+            return Result<void>::err("weight limit exceeded");
+        if (slots > static_cast<long long>(std::max(slotLimit_, used_)))
+            return Result<void>::err("slot limit reached");
+        return Result<void>::ok();
+    }
+
+    void commitBatch(BatchPlan& plan) {
+        auto& emptied = plan.emptied;
+        for (const auto& p : plan) {
+            for (const auto& st : p.stacks) {
+                if (st.slot == npos) {
+                    if (st.size == 0) continue;
+                    Item stack = *st.proto;
+                    stack.stackSize = st.size;
+                    pushStack(std::move(stack));
+                } else if (st.size == 0) {
+                    emptied.push_back(st.slot);
+                } else if (st.size != slots_[st.slot].item.stackSize) {
+                    setStackSize(st.slot, st.size);
+                }
+            }
+        }
+        // after the pushes, so new stacks never land in a slot we still read
+        for (std::size_t slot : emptied) eraseStack(slot);
+    }
+
+    // -----------------------------------------------------------------
+    //  Compaction internals
+    // -----------------------------------------------------------------
+    // pours the last partial stack of each id into the first one; every
+    // step fills a stack or empties one, so this is linear in the number
+    // of partial stacks
+    void mergePartials() {
+        for (auto& entry : index_) {
+            auto& partial = entry.second.partial;
+            while (partial.size() > 1) {
+                std::size_t dst = partial.front();
+                std::size_t src = partial.back();
+                int move = std::min(roomLeft(slots_[dst].item), slots_[src].item.stackSize);
+                int left = slots_[src].item.stackSize - move;
+                setStackSize(dst, slots_[dst].item.stackSize + move);
+                if (left == 0) eraseStack(src);     // never the id's last stack
+                else           setStackSize(src, left);
+            }
+        }
+    }
+
+    static bool canonicalLess(const Item& a, const Item& b) {
+        if (a.type()  != b.type())  return a.type() < b.type();
+        if (a.rarity  != b.rarity)  return a.rarity > b.rarity;
+        if (a.name()  != b.name())  return a.name() < b.name();
+        if (a.id()    != b.id())    return a.id() < b.id();
+        return a.stackSize > b.stackSize;
+    }
+
+    // kept between calls so compaction doesn't allocate once warmed up
+    struct CompactScratch {
+        std::vector<std::uint32_t> src;     // position → slot whose content lands there
+        std::vector<std::uint32_t> pos;     // slot → its new position
+        std::vector<std::uint32_t> gen;     // per‑position generation before the move
+    };
+    CompactScratch compactScratch_;
+
+    void sortSlots() {
+        auto& [src, pos, gen] = compactScratch_;
+        const std::size_t n = slots_.size();
+
+        src.clear();
+        for (std::size_t i = 0; i < n; ++i)
+            if (slots_[i].occupied) src.push_back(static_cast<std::uint32_t>(i));
+        std::sort(src.begin(), src.end(), [&](std::uint32_t a, std::uint32_t b) {
+            const Item& x = slots_[a].item;
+            const Item& y = slots_[b].item;
+            if (canonicalLess(x, y)) return true;
+            if (canonicalLess(y, x)) return false;
+            return a < b;
+        });
+        for (std::size_t i = 0; i < n; ++i)
+            if (!slots_[i].occupied) src.push_back(static_cast<std::uint32_t>(i));
+
+        pos.resize(n);
+        gen.resize(n);
+        for (std::size_t p = 0; p < n; ++p) {
+            pos[src[p]] = static_cast<std::uint32_t>(p);
+            gen[p] = slots_[p].generation;
+        }
+        // apply the permutation in place by walking its cycles
+        for (std::size_t p = 0; p < n; ++p) {
+            while (pos[p] != p) {
+                std::uint32_t q = pos[p];
+                std::swap(slots_[p], slots_[q]);
+                std::swap(pos[p], pos[q]);
+            }
+        }
+        // generations and dirty flags belong to positions, not contents
+        for (std::size_t p = 0; p < n; ++p) {
+            pos[src[p]] = static_cast<std::uint32_t>(p);
+            slots_[p].generation = src[p] == p ? gen[p] : gen[p] + 1;
+            slots_[p].dirty = false;
+        }
+        for (std::uint32_t d : dirtySlots_) slots_[d].dirty = true;
+        for (std::size_t p = 0; p < n; ++p)
+            if (src[p] != p) markDirty(p);
+
+        for (auto& entry : index_) {
+            for (auto& slot : entry.second.slots)   slot = pos[slot];
+            for (auto& slot : entry.second.partial) slot = pos[slot];
+        }
+        for (auto& t : typeIndex_) rekey(t, [&](std::uint32_t& slot) { slot = pos[slot]; });
+        for (auto& k : keyIndex_)  rekey(k, [&](std::pair<int, std::uint32_t>& e) { e.second = pos[e.second]; });
+
+        // same number of free slots as before, so no reallocation here
+        freeSlots_.clear();
+        for (std::size_t p = n; p-- > used_;) freeSlots_.push_back(static_cast<std::uint32_t>(p));
+    }
+
+    // moves every node into a fresh set under a new key – no allocation
+    template <typename Set, typename F>
+    static void rekey(Set& set, F&& update) {
+        Set fresh;
+        while (!set.empty()) {
+            auto node = set.extract(set.begin());
+            update(node.value());
+            fresh.insert(std::move(node));
+        }
+        set.swap(fresh);
+    }
+
+    // O(1) removal: the slot goes onto the free‑list, other slots stay put
+    void eraseStack(std::size_t slot) {
+        Slot& s = slots_[slot];
+        indexErase(slot);
+        auto found = index_.find(s.item.id());
+        StackIndex& idx = found->second;
+        if (s.inPartial != npos) unlinkPartial(idx, slot);
+
+        std::size_t pos = s.inSlots;
+        idx.slots[pos] = idx.slots.back();
+        slots_[idx.slots[pos]].inSlots = pos;
+        idx.slots.pop_back();
+        craftable_.update(s.item.id(), idx.total, idx.total - s.item.stackSize);
+        idx.total -= s.item.stackSize;
+        account(s.item, -s.item.stackSize);
+        if (idx.slots.empty()) index_.erase(found);
+
+        s.item = Item{};
+        s.occupied = false;
+        s.inSlots = npos;
+        ++s.generation;
+        --used_;
+        markDirty(slot);
+        freeSlots_.push_back(static_cast<std::uint32_t>(slot));
+    }
+
+    bool isLive(SlotHandle h) const {
+        return h.index < slots_.size() && slots_[h.index].occupied &&
+               slots_[h.index].generation == h.generation;
     }
 };
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "inventory.hpp"
+#include "result.hpp"
+
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+/*======================================================================
+ *  8) InventoryRegistry – player id → Inventory for multi‑threaded servers
+ *     The map is split into shards with their own reader/writer lock,
+ *     and every inventory carries its own mutex. A lookup only holds the
+ *     shard lock long enough to copy a shared_ptr, so workers operating
+ *     on different players never wait on each other.
+ *====================================================================*/
+class InventoryRegistry {
+public:
+    using Key = std::uint64_t;             // external player / account id
+
+    struct Entry {
+        Entry(Key k, std::size_t slotLimit, int weightLimit)
+            : key(k), inv(slotLimit, weightLimit) {}
+
+        const Key  key;
+        std::mutex mtx;                    // guards `inv`
+        Inventory  inv;
+    };
+    using Handle = std::shared_ptr<Entry>;
+
+    explicit InventoryRegistry(std::size_t shardCount = 64)
+        : shards_(shardCount == 0 ? 1 : shardCount) {}
+
+    Result<void> create(Key player, std::size_t slotLimit = 30, int weightLimit = 300) {
+        Shard& sh = shardFor(player);
+        std::unique_lock<std::shared_mutex> lock(sh.mtx);
+        auto [it, inserted] = sh.map.try_emplace(player, nullptr);
+        if (!inserted)
+            return Result<void>::err("player " + std::to_string(player) + " already registered");
+        it->second = std::make_shared<Entry>(player, slotLimit, weightLimit);
+        return Result<void>::ok();
+    }
+
+    // in‑flight operations on the removed inventory finish on their own copy
+    Result<void> erase(Key player) {
+        Shard& sh = shardFor(player);
+        std::unique_lock<std::shared_mutex> lock(sh.mtx);
+        if (sh.map.erase(player) == 0)
+            return Result<void>::err("unknown player " + std::to_string(player));
+        return Result<void>::ok();
+    }
+
+    bool contains(Key player) const { return acquire(player) != nullptr; }
+
+    std::size_t size() const {
+        std::size_t n = 0;
+        for (const auto& sh : shards_) {
+            std::shared_lock<std::shared_mutex> lock(sh.mtx);
+            n += sh.map.size();
+        }
+        return n;
+    }
+
+    // raw handle for operations spanning several inventories; callers must
+    // lock Entry::mtx themselves before touching Entry::inv
+    Handle acquire(Key player) const {
+        const Shard& sh = shardFor(player);
+        std::shared_lock<std::shared_mutex> lock(sh.mtx);
+        auto it = sh.map.find(player);
+        return it == sh.map.end() ? nullptr : it->second;
+    }
+
+    // runs fn(Inventory&) under that player's lock; fn returns a Result<…>
+    template <typename F>
+    std::invoke_result_t<F, Inventory&> with(Key player, F&& fn) {
+        using R = std::invoke_result_t<F, Inventory&>;
+        Handle entry = acquire(player);
+        if (!entry) return R::err("unknown player " + std::to_string(player));
+        std::lock_guard<std::mutex> lock(entry->mtx);
+        return std::forward<F>(fn)(entry->inv);
+    }
+
+    std::size_t shardCount() const { return shards_.size(); }
+
+private:
+    struct alignas(64) Shard {             // one cache line per lock
+        mutable std::shared_mutex mtx;
+        std::unordered_map<Key, Handle> map;
+    };
+
+    std::vector<Shard> shards_;
+
+    Shard& shardFor(Key player) {
+        return shards_[mix(player) % shards_.size()];
+    }
+    const Shard& shardFor(Key player) const {
+        return shards_[mix(player) % shards_.size()];
+    }
+
+    // strided ids (region prefixes, multiples of the shard count) would
+    // otherwise pile into a few shards
+    static std::uint64_t mix(std::uint64_t x) {
+        x ^= x >> 33; x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33; x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return x;
+    }
+};
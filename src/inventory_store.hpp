@@ -0,0 +1,361 @@
+#pragma once
+
+#include "item.hpp"
+#include "item_id.hpp"
+#include "result.hpp"
+#include "weight_sum.hpp"
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+#include <variant>
+#include <utility>
+
+/*======================================================================
+ *  7) InventoryStore – struct‑of‑arrays storage for many inventories
+ *     Every player owns a fixed run of `slotsPerPlayer` rows in each
+ *     column, so population‑wide passes are plain loops over packed
+ *     arrays. Cold per‑stack data (shared template + rolled payload)
+ *     sits in a side pool addressed by the payload column.
+ *====================================================================*/
+using PlayerId = std::uint32_t;
+
+class InventoryStore {
+public:
+    class View;
+
+    explicit InventoryStore(std::size_t slotsPerPlayer = 30, int weightLimit = 300)
+        : slotsPerPlayer_(slotsPerPlayer), weightLimit_(weightLimit) {}
+
+    // -----------------------------------------------------------------
+    //  Population management
+    // -----------------------------------------------------------------
+    PlayerId addPlayer() {
+        if (!freePlayers_.empty()) {
+            PlayerId p = freePlayers_.back();
+            freePlayers_.pop_back();
+            alive_[p] = 1;
+            return p;
+        }
+        PlayerId p = static_cast<PlayerId>(weight_.size());
+        std::size_t rows = id_.size() + slotsPerPlayer_;
+        id_.resize(rows);
+        stackSize_.resize(rows, 0);
+        unitWeight_.resize(rows, 0);
+        rarity_.resize(rows, 0);
+        levelReq_.resize(rows, 0);
+        payload_.resize(rows, 0);
+        weight_.push_back(0);
+        used_.push_back(0);
+        alive_.push_back(1);
+        return p;
+    }
+
+    void removePlayer(PlayerId p) {
+        if (!isAlive(p)) return;
+        for (std::size_t row = begin(p); row < end(p); ++row)
+            if (id_[row]) clearRow(p, row);
+        alive_[p] = 0;
+        freePlayers_.push_back(p);
+    }
+
+    bool isAlive(PlayerId p) const { return p < alive_.size() && alive_[p]; }
+    std::size_t playerCount() const { return weight_.size() - freePlayers_.size(); }
+    std::size_t slotsPerPlayer() const { return slotsPerPlayer_; }
+
+    View view(PlayerId p);
+
+    // -----------------------------------------------------------------
+    //  Per‑player operations (same semantics as Inventory). A PlayerId
+    //  that was never handed out or has been removed is an error for the
+    //  mutators and reads as an empty inventory – its rows may already
+    //  belong to the next addPlayer().
+    // -----------------------------------------------------------------
+    Result<void> addItem(PlayerId p, const Item& item) {
+        auto can = canAdd(p, item);
+        if (!can) return can;
+
+        int remaining = item.stackSize;
+        if (item.maxStack() > 1) {
+            for (std::size_t row = begin(p); row < end(p) && remaining > 0; ++row) {
+                if (id_[row] != item.id()) continue;
+                int room = maxStack(row) - stackSize_[row];
+                if (room <= 0) continue;
+                int transfer = std::min(room, remaining);
+                stackSize_[row] += transfer;
+                weight_[p] += unitWeight(row) * transfer;
+                remaining -= transfer;
+            }
+        }
+
+        std::size_t row = begin(p);
+        while (remaining > 0) {
+            while (id_[row]) ++row;                 // canAdd guaranteed enough empty rows
+            int thisStack = std::min(remaining, item.maxStack());
+            fillRow(p, row, item, thisStack);
+            remaining -= thisStack;
+        }
+        return Result<void>::ok();
+    }
+
+    Result<void> removeItem(PlayerId p, ItemId id, int quantity = 1) {
+        if (!isAlive(p)) return unknownPlayer(p);
+        if (quantity <= 0) return Result<void>::ok();
+        if (count(p, id) < quantity)
+            return Result<void>::err("item not found in inventory");
+
+        int remaining = quantity;
+        for (std::size_t row = begin(p); row < end(p) && remaining > 0; ++row) {
+            if (id_[row] != id) continue;
+            if (stackSize_[row] > remaining) {
+                stackSize_[row] -= remaining;
+                weight_[p] -= unitWeight(row) * remaining;
+                remaining = 0;
+            } else {
+                remaining -= stackSize_[row];
+                clearRow(p, row);
+            }
+        }
+        return Result<void>::ok();
+    }
+
+    int count(PlayerId p, ItemId id) const {
+        if (!isAlive(p)) return 0;
+        int sum = 0;
+        for (std::size_t row = begin(p); row < end(p); ++row)
+            if (id_[row] == id) sum += stackSize_[row];
+        return sum;
+    }
+
+    Result<void> canAdd(PlayerId p, const Item& item) const {
+        if (!isAlive(p)) return unknownPlayer(p);
+        if (weight_[p] + item.getWeight() > weightLimit_)
+            return Result<void>::err("weight limit would be exceeded");
+
+        int room = 0;
+        std::size_t freeRows = 0;
+        for (std::size_t row = begin(p); row < end(p); ++row) {
+            if (!id_[row]) ++freeRows;
+            else if (id_[row] == item.id())
+                room += std::max(0, maxStack(row) - stackSize_[row]);
+        }
+
+        std::size_t neededSlots = static_cast<std::size_t>(item.stackSize);
+        if (item.maxStack() > 1) {
+            int remaining = std::max(0, item.stackSize - room);
+            neededSlots = static_cast<std::size_t>((remaining + item.maxStack() - 1) / item.maxStack());
+        }
+        if (neededSlots > freeRows)
+            return Result<void>::err("no free inventory slot for the item");
+        return Result<void>::ok();
+    }
+
+    int totalWeight(PlayerId p) const { return isAlive(p) ? weight_[p] : 0; }
+    std::size_t usedSlots(PlayerId p) const { return isAlive(p) ? used_[p] : 0; }
+
+    // rebuilds an Item from the columns; empty rows (and slots out of
+    // range) yield an invalid id
+    Item getItem(PlayerId p, std::size_t slot) const {
+        Item it;
+        if (!isAlive(p) || slot >= slotsPerPlayer_) return it;
+        std::size_t row = begin(p) + slot;
+        if (!id_[row]) return it;
+        const Cold& c = cold_[payload_[row]];
+        it.tmpl       = c.tmpl;
+        it.rarity     = static_cast<Rarity>(rarity_[row]);
+        it.levelReq   = levelReq_[row];
+        it.stackSize  = stackSize_[row];
+        it.unitWeight = unitWeight_[row];
+        it.data       = c.data;
+        return it;
+    }
+
+    std::vector<Item> getItems(PlayerId p) const {
+        std::vector<Item> out;
+        if (!isAlive(p)) return out;
+        out.reserve(used_[p]);
+        for (std::size_t slot = 0; slot < slotsPerPlayer_; ++slot)
+            if (id_[begin(p) + slot]) out.push_back(getItem(p, slot));
+        return out;
+    }
+
+    // -----------------------------------------------------------------
+    //  Population‑wide passes – straight loops over the columns
+    // -----------------------------------------------------------------
+
+    // recomputes every player's weight from its rows; returns how many
+    // cached totals were wrong (and have been corrected). Empty rows have
+    // stackSize 0, so each player is one dot product over two columns.
+    std::size_t auditWeights() {
+        std::size_t mismatches = 0;
+        for (PlayerId p = 0; p < weight_.size(); ++p) {
+            int sum = static_cast<int>(WeightSum::dot(&unitWeight_[begin(p)], &stackSize_[begin(p)],
+                                                      slotsPerPlayer_));
+            if (sum != weight_[p]) { weight_[p] = sum; ++mismatches; }
+        }
+        return mismatches;
+    }
+
+    // rebuilds every player's cached used‑slot count and weight from the
+    // columns in one pass; returns how many players had a wrong total
+    std::size_t recomputeTotals() {
+        std::size_t mismatches = 0;
+        for (PlayerId p = 0; p < weight_.size(); ++p) {
+            std::uint32_t used = 0;
+            long long weight = 0;
+            for (std::size_t row = begin(p); row < end(p); ++row) {
+                used   += id_[row] ? 1u : 0u;
+                weight += static_cast<long long>(unitWeight_[row]) * stackSize_[row];
+            }
+            if (used != used_[p] || weight != weight_[p]) {
+                used_[p]   = used;
+                weight_[p] = static_cast<int>(weight);
+                ++mismatches;
+            }
+        }
+        return mismatches;
+    }
+
+    // per‑player sums of the rolled combat stats in the bag, indexed by
+    // PlayerId (dead players come out zero); `out` is reused
+    struct StatTotals {
+        long long damage{0};
+        long long defense{0};
+        long long healing{0};       // healAmount × units
+    };
+    void recomputeStats(std::vector<StatTotals>& out) const {
+        out.assign(weight_.size(), StatTotals{});
+        for (std::size_t row = 0; row < id_.size(); ++row) {
+            if (!id_[row]) continue;
+            StatTotals& t = out[row / slotsPerPlayer_];
+            const long long units = stackSize_[row];
+            std::visit([&](const auto& d) {
+                using T = std::decay_t<decltype(d)>;
+                if constexpr (std::is_same_v<T, WeaponData>)          t.damage  += d.damage * units;
+                else if constexpr (std::is_same_v<T, ArmorData>)      t.defense += d.defense * units;
+                else if constexpr (std::is_same_v<T, ConsumableData>) t.healing += d.healAmount * units;
+            }, cold_[payload_[row]].data);
+        }
+    }
+
+    // players whose (cached) weight exceeds the store limit
+    std::vector<PlayerId> overweightPlayers() const {
+        std::vector<PlayerId> out;
+        for (PlayerId p = 0; p < weight_.size(); ++p)
+            if (alive_[p] && weight_[p] > weightLimit_) out.push_back(p);
+        return out;
+    }
+
+    // removes every stack of `id` from every player; returns units removed
+    long long wipeItem(ItemId id) {
+        long long removed = 0;
+        for (std::size_t row = 0; row < id_.size(); ++row) {
+            if (id_[row] != id) continue;
+            removed += stackSize_[row];
+            clearRow(static_cast<PlayerId>(row / slotsPerPlayer_), row);
+        }
+        return removed;
+    }
+
+    // raw columns for custom passes (row = player * slotsPerPlayer + slot)
+    const std::vector<ItemId>&        ids()         const { return id_; }
+    const std::vector<std::int32_t>&  stackSizes()  const { return stackSize_; }
+    const std::vector<std::int32_t>&  unitWeights() const { return unitWeight_; }
+    const std::vector<std::uint8_t>&  rarities()    const { return rarity_; }
+    const std::vector<std::uint16_t>& levelReqs()   const { return levelReq_; }
+    const std::vector<std::uint32_t>& payloads()    const { return payload_; }
+    const ItemPayload& payload(std::uint32_t index) const { return cold_[index].data; }
+
+private:
+    struct Cold {
+        const ItemTemplate* tmpl{&ItemTemplates::empty};
+        ItemPayload         data;
+    };
+
+    std::size_t slotsPerPlayer_;
+    int weightLimit_;
+
+    // hot columns, one row per slot
+    std::vector<ItemId>        id_;            // invalid id = empty row
+    std::vector<std::int32_t>  stackSize_;     // 0 on empty rows
+    std::vector<std::int32_t>  unitWeight_;    // per unit, copied from the item
+    std::vector<std::uint8_t>  rarity_;
+    std::vector<std::uint16_t> levelReq_;
+    std::vector<std::uint32_t> payload_;       // index into cold_
+
+    // per‑player columns
+    std::vector<int>           weight_;
+    std::vector<std::uint32_t> used_;         // occupied rows; slotsPerPlayer may exceed 65535
+    std::vector<std::uint8_t>  alive_;
+    std::vector<PlayerId>      freePlayers_;
+
+    std::vector<Cold>          cold_;
+    std::vector<std::uint32_t> freeCold_;
+
+    std::size_t begin(PlayerId p) const { return static_cast<std::size_t>(p) * slotsPerPlayer_; }
+    std::size_t end(PlayerId p)   const { return begin(p) + slotsPerPlayer_; }
+
+    static Result<void> unknownPlayer(PlayerId p) {
+        return Result<void>::err("unknown player " + std::to_string(p));
+    }
+
+    int maxStack(std::size_t row) const { return cold_[payload_[row]].tmpl->maxStack; }
+
+    int unitWeight(std::size_t row) const { return unitWeight_[row]; }
+
+    void fillRow(PlayerId p, std::size_t row, const Item& item, int stackSize) {
+        std::uint32_t c;
+        if (!freeCold_.empty()) { c = freeCold_.back(); freeCold_.pop_back(); }
+        else { c = static_cast<std::uint32_t>(cold_.size()); cold_.emplace_back(); }
+        cold_[c] = Cold{item.tmpl, item.data};
+
+        id_[row]         = item.id();
+        stackSize_[row]  = stackSize;
+        unitWeight_[row] = item.unitWeight;
+        rarity_[row]     = static_cast<std::uint8_t>(item.rarity);
+        levelReq_[row]   = item.levelReq;
+        payload_[row]    = c;
+        weight_[p]      += unitWeight(row) * stackSize;
+        ++used_[p];
+    }
+
+    void clearRow(PlayerId p, std::size_t row) {
+        weight_[p] -= unitWeight(row) * stackSize_[row];
+        --used_[p];
+        freeCold_.push_back(payload_[row]);
+        id_[row]        = ItemId{};
+        stackSize_[row] = 0;
+    }
+};
+
+/* -----------------------------------------------------------------
+   Inventory‑compatible facade over one player's rows
+   ----------------------------------------------------------------- */
+class InventoryStore::View {
+public:
+    View(InventoryStore& store, PlayerId player) : store_(&store), player_(player) {}
+
+    Result<void> addItem(const Item& item)               { return store_->addItem(player_, item); }
+    Result<void> removeItem(ItemId id, int quantity = 1) { return store_->removeItem(player_, id, quantity); }
+    Result<void> removeItem(const std::string& id, int quantity = 1) {
+        return removeItem(ItemIds::find(id), quantity);
+    }
+    int count(ItemId id) const                  { return store_->count(player_, id); }
+    int count(const std::string& id) const      { return count(ItemIds::find(id)); }
+    Result<void> canAdd(const Item& item) const { return store_->canAdd(player_, item); }
+
+    int totalWeight() const          { return store_->totalWeight(player_); }
+    size_t usedSlots() const         { return store_->usedSlots(player_); }
+    std::vector<Item> getItems() const { return store_->getItems(player_); }
+
+    PlayerId player() const { return player_; }
+
+private:
+    InventoryStore* store_;
+    PlayerId        player_;
+};
+
+inline InventoryStore::View InventoryStore::view(PlayerId p) { return View(*this, p); }
@@ -2,12 +2,24 @@
 
 #include "json.hpp"
 #include "enums.hpp"
+#include "item_id.hpp"
 #include "result.hpp"
 
 #include <variant>
 #include <string>
-#include <sstream>
-#include <cassert>
+#include <string_view>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <array>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
 
 /*======================================================================
  *  3) Item data structures (type‑erased) + JSON conversions
@@ -32,6 +44,16 @@ struct MiscData {
     int weight{0};
 };
 
+inline bool operator==(const WeaponData& a, const WeaponData& b) {
+    return a.damage == b.damage && a.durability == b.durability && a.weight == b.weight;
+}
+inline bool operator==(const ArmorData& a, const ArmorData& b)     { return a.defense == b.defense && a.weight == b.weight; }
+inline bool operator==(const ConsumableData& a, const ConsumableData& b) {
+    return a.healAmount == b.healAmount && a.weight == b.weight;
+}
+inline bool operator==(const MaterialData& a, const MaterialData& b) { return a.weight == b.weight; }
+inline bool operator==(const MiscData& a, const MiscData& b)         { return a.weight == b.weight; }
+
 inline void to_json(json& j, const WeaponData& w){
     j = json{{"damage",w.damage},{"durability",w.durability},{"weight",w.weight}};
 }
@@ -79,50 +101,187 @@ using ItemPayload = std::variant<
     MiscData
 >;
 
-struct Item {
-    std::string id;               // e.g. "iron_sword"
-    std::string name;             // human readable
+// every payload carries a weight; read it once, not on every access
+inline int payloadWeight(const ItemPayload& data) {
+    return std::visit([](const auto& d) { return d.weight; }, data);
+}
+
+/*----------------------------------------------------------------------
+   Immutable per‑id data, stored once and shared by every stack (flyweight)
+ ----------------------------------------------------------------------*/
+struct ItemTemplate {
+    ItemId      id;
+    std::string name;                 // base name, without rarity prefix
     ItemType    type{ItemType::Misc};
-    Rarity     rarity{Rarity::Common};
-    int        levelReq{1};
-    int        stackSize{1};      // how many we have in this stack
-    int        maxStack{1};       // max per slot (1 = non‑stackable)
-    ItemPayload data;             // type‑specific fields
-
-    [[nodiscard]] int getWeight() const {
-        struct Visitor {
-            int stackSize;
-            int operator()(const WeaponData& w)      const { return w.weight * stackSize; }
-            int operator()(const ArmorData& a)       const { return a.weight * stackSize; }
-            int operator()(const ConsumableData& c)  const { return c.weight * stackSize; }
-            int operator()(const MaterialData& m)    const { return m.weight * stackSize; }
-            int operator()(const MiscData& m)        const { return m.weight * stackSize; }
-        };
-        return std::visit(Visitor{stackSize}, data);
+    int         maxStack{1};          // max per slot (1 = non‑stackable)
+    EquipSlot   slot{EquipSlot::None};
+    ItemPayload data;                 // base stats before rarity rolls
+
+    friend bool operator==(const ItemTemplate& a, const ItemTemplate& b) {
+        return a.id == b.id && a.name == b.name && a.type == b.type &&
+               a.maxStack == b.maxStack && a.slot == b.slot && a.data == b.data;
+    }
+};
+
+// Process‑wide catalog. Entries are never freed or modified, so items may
+// hold plain pointers to them; reloading a changed template appends a new
+// version and older items keep the one they were created from.
+// Memory: versions are not reference counted, so they live until exit.
+// A reload only adds a version for content never seen before for that
+// id – an unchanged file, or an edit that is reverted, reuses what is
+// already here – so the catalog grows with the number of distinct
+// template edits over the process lifetime, not with the number of
+// reloads. The display‑name cache below adds at most kRarityCount − 1
+// strings per version.
+namespace ItemTemplates {
+    inline const ItemTemplate empty{};                   // default for Item
+    inline std::shared_mutex mtx;
+    inline std::deque<ItemTemplate> versions;           // deque: stable addresses
+    inline std::unordered_map<ItemId, const ItemTemplate*> current;
+    inline std::unordered_map<ItemId, std::vector<const ItemTemplate*>> history;   // every version per id
+
+    // current version for `id`, nullptr if none was ever registered
+    inline const ItemTemplate* find(ItemId id) {
+        std::shared_lock<std::shared_mutex> lock(mtx);
+        auto it = current.find(id);
+        return it == current.end() ? nullptr : it->second;
     }
 
-    [[nodiscard]] int weightPerUnit() const {
-        assert(stackSize > 0 && "stackSize must be > 0");
-        return getWeight() / stackSize;
+    // makes `t` the current version of its id, reusing an identical
+    // earlier version (current or not) instead of storing a copy
+    inline const ItemTemplate& intern(ItemTemplate t) {
+        std::unique_lock<std::shared_mutex> lock(mtx);
+        auto it = current.find(t.id);
+        if (it != current.end() && *it->second == t) return *it->second;
+        std::vector<const ItemTemplate*>& seen = history[t.id];
+        for (const ItemTemplate* v : seen) {
+            if (*v == t) {
+                current[v->id] = v;
+                return *v;
+            }
+        }
+        versions.push_back(std::move(t));
+        const ItemTemplate* added = &versions.back();
+        seen.push_back(added);
+        current[added->id] = added;
+        return *added;
+    }
+
+    // stand‑ins for ids a save used before any catalog entry existed:
+    // stored like a version but never made current, so ItemTemplates::find
+    // keeps reporting "no catalog entry" and the real template wins as
+    // soon as it is interned. One per id – the first one built is kept.
+    inline std::unordered_map<ItemId, const ItemTemplate*> standIns;
+
+    inline const ItemTemplate& standIn(ItemTemplate t) {
+        std::unique_lock<std::shared_mutex> lock(mtx);
+        auto it = standIns.find(t.id);
+        if (it != standIns.end()) return *it->second;
+        versions.push_back(std::move(t));
+        const ItemTemplate* added = &versions.back();
+        history[added->id].push_back(added);
+        standIns.emplace(added->id, added);
+        return *added;
+    }
+
+    // versions stored so far, across all ids (see the memory note above)
+    inline std::size_t versionCount() {
+        std::shared_lock<std::shared_mutex> lock(mtx);
+        return versions.size();
+    }
+
+    // display names, built the first time one is asked for and kept for
+    // the life of the process (templates never die, so neither do these;
+    // bounded by versions × rarities)
+    inline std::shared_mutex nameMtx;
+    inline std::deque<std::string> nameStore;                   // deque: stable addresses
+    inline std::unordered_map<const ItemTemplate*, std::array<const std::string*, kRarityCount>> names;
+
+    // "Rare Iron Sword"; Common is the template name itself
+    inline std::string_view displayName(const ItemTemplate& t, Rarity r) {
+        std::string_view prefix = rarityPrefix(r);
+        if (prefix.empty()) return t.name;
+        const auto slot = static_cast<std::size_t>(r);
+        {
+            std::shared_lock<std::shared_mutex> lock(nameMtx);
+            auto it = names.find(&t);
+            if (it != names.end() && it->second[slot]) return *it->second[slot];
+        }
+        std::unique_lock<std::shared_mutex> lock(nameMtx);
+        const std::string*& cached = names[&t][slot];
+        if (!cached) {
+            std::string& s = nameStore.emplace_back();
+            s.reserve(prefix.size() + 1 + t.name.size());
+            s.append(prefix).append(1, ' ').append(t.name);
+            cached = &s;
+        }
+        return *cached;
     }
+}
+
+struct Item {
+    const ItemTemplate* tmpl{&ItemTemplates::empty};   // shared, never null
+    int           stackSize{1};       // how many we have in this stack
+    int           unitWeight{0};      // == data's weight, hoisted out of the variant
+    std::uint16_t levelReq{1};
+    Rarity        rarity{Rarity::Common};
+    ItemPayload   data;               // rolled stats, durability
+
+    Item() = default;
+    explicit Item(const ItemTemplate& t, int count = 1)
+        : tmpl(&t), stackSize(count), unitWeight(payloadWeight(t.data)), data(t.data) {}
+
+    ItemId             id()       const { return tmpl->id; }
+    const std::string& name()     const { return tmpl->name; }
+    ItemType           type()     const { return tmpl->type; }
+    int                maxStack() const { return tmpl->maxStack; }
+    EquipSlot          slot()     const { return tmpl->slot; }
+
+    // "Rare Iron Sword" – nothing is stored per item; the string is
+    // shared per (template, rarity) and only built when first shown
+    std::string_view displayName() const { return ItemTemplates::displayName(*tmpl, rarity); }
+
+    // code that replaces `data` must refresh `unitWeight` (payloadWeight)
+    [[nodiscard]] int getWeight() const     { return unitWeight * stackSize; }
+    [[nodiscard]] int weightPerUnit() const { return unitWeight; }
 
     std::string getDescription() const {
-        std::ostringstream ss;
-        ss << rarityColor(rarity) << name << resetColor()
-           << " (x" << stackSize << ") – " << toString(type);
+        std::string out;
+        appendDescription(out);
+        return out;
+    }
+
+    // appends the getDescription() text; reusing `out` across calls means
+    // no heap allocation once it has grown to fit
+    void appendDescription(std::string& out) const {
+        auto number = [&out](int v) {
+            char buf[16];
+            auto res = std::to_chars(buf, buf + sizeof buf, v);
+            out.append(buf, res.ptr);
+        };
+        std::string_view prefix = rarityPrefix(rarity);
+        out.append(rarityColorCode(rarity));
+        if (!prefix.empty()) out.append(prefix).append(1, ' ');
+        out.append(name()).append(kResetColor).append(" (x");
+        number(stackSize);
+        out.append(") – ").append(typeName(type()));
         std::visit([&](auto&& d) {
             using T = std::decay_t<decltype(d)>;
             if constexpr (std::is_same_v<T, WeaponData>) {
-                ss << " [DMG:" << d.damage
-                   << (d.durability >= 0 ? ("/" + std::to_string(d.durability)) : "")
-                   << "]";
+                out.append(" [DMG:");
+                number(d.damage);
+                if (d.durability >= 0) { out.push_back('/'); number(d.durability); }
+                out.push_back(']');
             } else if constexpr (std::is_same_v<T, ArmorData>) {
-                ss << " [DEF:" << d.defense << "]";
+                out.append(" [DEF:");
+                number(d.defense);
+                out.push_back(']');
             } else if constexpr (std::is_same_v<T, ConsumableData>) {
-                ss << " [HEAL:" << d.healAmount << "]";
+                out.append(" [HEAL:");
+                number(d.healAmount);
+                out.push_back(']');
             }
         }, data);
-        return ss.str();
     }
 
     std::string serialize() const {
@@ -142,35 +301,98 @@ struct Item {
     }
 };
 
+// "1) <description>\n" per item – a whole inventory screen in one call
+template <typename Range>
+void appendDescriptions(std::string& out, const Range& items) {
+    std::size_t n = 0;
+    for (const Item& it : items) {
+        char buf[24];
+        auto res = std::to_chars(buf, buf + sizeof buf, ++n);
+        out.append(buf, res.ptr).append(") ");
+        it.appendDescription(out);
+        out.push_back('\n');
+    }
+}
+
 /* -----------------------------------------------------------------
-   JSON conversion for Item (required by our json class)
+   JSON conversion for ItemTemplate / Item (required by our json class)
+   Items keep the old flat layout – template fields are written out
+   with every item, so saves stay readable without the catalog.
    ----------------------------------------------------------------- */
+inline ItemPayload payloadFromJson(ItemType type, const json& d) {
+    switch (type) {
+        case ItemType::Weapon:      return d.get<WeaponData>();
+        case ItemType::Armor:       return d.get<ArmorData>();
+        case ItemType::Consumable:  return d.get<ConsumableData>();
+        case ItemType::Material:    return d.get<MaterialData>();
+        default:                    return d.get<MiscData>();
+    }
+}
+
+inline void from_json(const json& j, ItemTemplate& t){
+    t.id       = ItemIds::intern(j.at("id").get<std::string>());
+    t.name     = j.at("name").get<std::string>();
+    t.type     = stringToItemType(j.at("type").get<std::string>());
+    t.maxStack = j.at("maxStack").get<int>();
+    t.slot     = j.contains("slot") ? stringToEquipSlot(j.at("slot").get<std::string>())
+                                    : deriveEquipSlot(t.type, j.at("id").get<std::string>());
+    t.data     = payloadFromJson(t.type, j.at("data"));
+}
+
 inline void to_json(json& j, const Item& i){
     j = json{
-        {"id", i.id},
-        {"name", i.name},
-        {"type", toString(i.type)},
+        {"id", ItemIds::name(i.id())},
+        {"name", std::string(i.displayName())},     // older saves/builds read it back
+        {"type", toString(i.type())},
         {"rarity", toString(i.rarity)},
-        {"levelReq", i.levelReq},
+        {"levelReq", static_cast<int>(i.levelReq)},
         {"stackSize", i.stackSize},
-        {"maxStack", i.maxStack}
+        {"maxStack", i.maxStack()},
+        {"slot", toString(i.slot())}
     };
     std::visit([&j](auto&& d){ j["data"] = d; }, i.data);
 }
+// undoes ItemFactory's rarity scaling: the smallest base stat that
+// rolls to the saved one (the roll truncates base × multiplier)
+inline void unscaleRolls(ItemPayload& data, Rarity r) {
+    const float mul = rarityMultiplier(r);
+    auto base = [mul](int rolled) { return static_cast<int>(std::ceil(rolled / mul - 1e-4f)); };
+    std::visit([&](auto& d) {
+        using T = std::decay_t<decltype(d)>;
+        if constexpr (std::is_same_v<T, WeaponData>) {
+            d.damage = base(d.damage);
+            if (d.durability > 0) d.durability = base(d.durability);
+        } else if constexpr (std::is_same_v<T, ArmorData>) {
+            d.defense = base(d.defense);
+        } else if constexpr (std::is_same_v<T, ConsumableData>) {
+            d.healAmount = base(d.healAmount);
+        }
+    }, data);
+}
+
 inline void from_json(const json& j, Item& i){
-    i.id        = j.at("id").get<std::string>();
-    i.name      = j.at("name").get<std::string>();
-    i.type      = stringToItemType(j.at("type").get<std::string>());
+    const int levelReq = j.at("levelReq").get<int>();
+    if (levelReq < 0 || levelReq > std::numeric_limits<std::uint16_t>::max())
+        throw std::runtime_error("levelReq " + std::to_string(levelReq) + " out of range");
     i.rarity    = stringToRarity(j.at("rarity").get<std::string>());
-    i.levelReq  = j.at("levelReq").get<int>();
+    i.levelReq  = static_cast<std::uint16_t>(levelReq);
     i.stackSize = j.at("stackSize").get<int>();
-    i.maxStack  = j.at("maxStack").get<int>();
-    const json& d = j.at("data");
-    switch (i.type) {
-        case ItemType::Weapon:      i.data = d.get<WeaponData>();      break;
-        case ItemType::Armor:       i.data = d.get<ArmorData>();       break;
-        case ItemType::Consumable:  i.data = d.get<ConsumableData>();  break;
-        case ItemType::Material:    i.data = d.get<MaterialData>();    break;
-        default:                    i.data = d.get<MiscData>();        break;
+
+    const ItemId id = ItemIds::intern(j.at("id").get<std::string>());
+    const ItemTemplate* t = ItemTemplates::find(id);
+    if (!t) {
+        // no catalog entry (e.g. a save loaded before the templates):
+        // a stand‑in rebuilt from the item itself, minus the rarity
+        // prefix and the rarity scaling
+        ItemTemplate fresh = j.get<ItemTemplate>();
+        std::string_view prefix = rarityPrefix(i.rarity);
+        if (!prefix.empty() && fresh.name.size() > prefix.size() &&
+            fresh.name.compare(0, prefix.size(), prefix) == 0 && fresh.name[prefix.size()] == ' ')
+            fresh.name.erase(0, prefix.size() + 1);
+        unscaleRolls(fresh.data, i.rarity);
+        t = &ItemTemplates::standIn(std::move(fresh));
     }
+    i.tmpl = t;
+    i.data = payloadFromJson(t->type, j.at("data"));
+    i.unitWeight = payloadWeight(i.data);
 }
@@ -3,8 +3,16 @@
 #include "item.hpp"
 #include "result.hpp"
 #include "enums.hpp"
+#include "logger.hpp"
+#include "alias_table.hpp"
+#include "loot_table.hpp"
+#include "rng_stream.hpp"
+#include "snapshot.hpp"
 
 #include <unordered_map>
+#include <vector>
+#include <memory>
+#include <mutex>
 #include <random>
 #include <string>
 #include <fstream>
@@ -13,115 +21,277 @@
 #include <iterator>
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
+
+/*======================================================================
+ *  4) ItemFactory – template‑based random item creation
+ *     The factory's own generator serves single‑threaded callers. For
+ *     parallel generation each worker takes a Stream: an independent
+ *     RngStream plus scratch space over the (read‑only) templates, so
+ *     no locks are needed and a given (seed, stream id) always yields
+ *     the same loot.
+ *     Templates live in an immutable TemplateCatalog snapshot; a reload
+ *     builds a new one and publishes it, so it may run while other
+ *     threads keep generating items from the previous catalog.
+ *====================================================================*/
+struct TemplateCatalog {
+    std::unordered_map<ItemId, const ItemTemplate*> byId;    // into ItemTemplates
+    std::vector<const ItemTemplate*> dropOrder;              // load order, indexed by dropTable
+    AliasTable dropTable;
+};
 
 class ItemFactory {
 public:
-    ItemFactory() {
-        rng_.seed(std::random_device{}());
-    }
+    class Stream;
 
-    Result<Item> create(const std::string& id, int playerLevel = 1) {
-        auto it = templates_.find(id);
-        if (it == templates_.end())
-            return Result<Item>::err("Unknown item id '" + id + "'");
+    // random master seed; seed() reports it so a session can be replayed
+    ItemFactory() : ItemFactory(freshSeed()) {}
 
-        Item result = it->second; // copy the template
-        result.levelReq = std::max(1, playerLevel - 2 + randInt(-1, 2));
+    explicit ItemFactory(std::uint64_t masterSeed)
+        : seed_(masterSeed), rng_(masterSeed, 0),
+          rarityTable_(std::vector<std::uint32_t>(kRarityWeights.begin(), kRarityWeights.end())) {}
 
-        // apply rarity – higher rarity => higher stats
-        result.rarity = randomRarity();
-        float rarityMul = 1.0f + static_cast<float>(static_cast<int>(result.rarity)) * 0.2f;
+    std::uint64_t seed() const { return seed_; }
 
-        std::visit([&](auto& data) {
-            using T = std::decay_t<decltype(data)>;
-            if constexpr (std::is_same_v<T, WeaponData>) {
-                data.damage = static_cast<int>(data.damage * rarityMul);
-                if (data.durability > 0) data.durability = static_cast<int>(data.durability * rarityMul);
-            } else if constexpr (std::is_same_v<T, ArmorData>) {
-                data.defense = static_cast<int>(data.defense * rarityMul);
-            } else if constexpr (std::is_same_v<T, ConsumableData>) {
-                data.healAmount = static_cast<int>(data.healAmount * rarityMul);
-            }
-        }, result.data);
+    // generator for one worker thread (stream 0 is the factory's own)
+    Stream stream(std::uint64_t streamId) const;
 
-        std::string prefix = rarityPrefix(result.rarity);
-        if (!prefix.empty())
-            result.name = prefix + " " + result.name;
+    // current catalog; holding the pointer keeps that generation alive.
+    // Takes the snapshot lock – hot paths use find() instead
+    Snapshot<TemplateCatalog>::Ptr catalog() const { return catalog_.load(); }
 
-        if (result.type == ItemType::Material || result.type == ItemType::Consumable) {
-            result.maxStack = 20;
-        } else {
-            result.maxStack = 1;
-        }
+    // current template of `id` through the factory's cached view, or
+    // nullptr; good until the factory's next call after a reload
+    const ItemTemplate* find(ItemId id) {
+        const TemplateCatalog& cat = reader_.get();
+        auto it = cat.byId.find(id);
+        return it == cat.byId.end() ? nullptr : it->second;
+    }
 
-        return Result<Item>::ok(std::move(result));
+    Result<Item> create(const std::string& id, int playerLevel = 1) {
+        ItemId handle = ItemIds::find(id);
+        if (!handle) return Result<Item>::err("Unknown item id '" + id + "'");
+        return create(handle, playerLevel);
     }
 
-    Result<Item> createRandomItem(int playerLevel = 1) {
-        if (templates_.empty())
-            return Result<Item>::err("No item templates loaded");
+    Result<Item> create(ItemId id, int playerLevel = 1) { return createWith(reader_.get(), id, playerLevel, rng_); }
+
+    Result<Item> createRandomItem(int playerLevel = 1) { return createRandomWith(reader_.get(), playerLevel, rng_); }
 
-        std::uniform_int_distribution<std::size_t> dist(0, templates_.size() - 1);
-        auto it = std::next(templates_.begin(), dist(rng_));
-        return create(it->first, playerLevel);
+    // appends `n` random drops to `out` – reuse the buffer across ticks
+    // and nothing is allocated once it has grown
+    Result<void> createBatch(std::size_t n, int playerLevel, std::vector<Item>& out) {
+        return createBatchWith(reader_.get(), n, playerLevel, out, rng_);
     }
 
+    // appends one roll of a loot table to `out`; stackable drops come as
+    // one stack, non‑stackable ones are rolled (rarity, stats) one by one
+    Result<void> rollLoot(const LootTables& tables, LootTables::TableId table, int playerLevel,
+                          std::vector<Item>& out) {
+        return rollLootWith(reader_.get(), tables, table, playerLevel, out, rng_, lootScratch_);
+    }
+
+    // publishes the file's templates as the whole catalog (one deleted
+    // from the file stops dropping); safe to call (e.g. from a
+    // FileWatcher) while other threads create
     Result<void> loadTemplates(const std::string& path) {
+        auto parsed = readTemplates(path);
+        if (!parsed) return Result<void>::err(parsed.error());
+        return replaceTemplates(std::move(parsed.value()));
+    }
+
+    // parses a templates file without touching any factory
+    static Result<std::vector<ItemTemplate>> readTemplates(const std::string& path) {
+        using R = Result<std::vector<ItemTemplate>>;
         std::ifstream in(path);
-        if (!in) return Result<void>::err("Cannot open templates file '" + path + "'");
+        if (!in) return R::err("Cannot open templates file '" + path + "'");
         std::string content((std::istreambuf_iterator<char>(in)), {});
         json j;
         try { j = json::parse(content); }
-        catch (const std::exception& e) { return Result<void>::err("JSON parse error: " + std::string(e.what())); }
+        catch (const std::exception& e) { return R::err("JSON parse error: " + std::string(e.what())); }
 
         if (!j.is_array())
-            return Result<void>::err("Templates file must contain a JSON array");
+            return R::err("Templates file must contain a JSON array");
 
+        std::vector<ItemTemplate> out;
+        out.reserve(j.size());
         for (const auto& elem : j) {
             try {
-                Item tmpl = elem.get<Item>();
-                templates_[tmpl.id] = tmpl;
+                out.push_back(elem.get<ItemTemplate>());
             } catch (const std::exception& e) {
                 Log::warn("Failed to parse template: " + std::string(e.what()));
             }
         }
+        return R::ok(std::move(out));
+    }
 
-        Log::info("Loaded " + std::to_string(templates_.size()) + " item templates.");
-        return Result<void>::ok();
+    // adds already‑built templates to the current catalog; an id it
+    // already holds gets the new version
+    Result<void> addTemplates(std::vector<ItemTemplate> templates) {
+        return publishTemplates(std::move(templates), true);
+    }
+
+    // publishes exactly these templates (from JSON or the binary catalog)
+    // as the new catalog
+    Result<void> replaceTemplates(std::vector<ItemTemplate> templates) {
+        return publishTemplates(std::move(templates), false);
     }
 
 private:
-    std::mt19937 rng_;
-    std::unordered_map<std::string, Item> templates_;
-
-    int randInt(int a, int b) { std::uniform_int_distribution<int> d(a, b); return d(rng_); }
-
-    Rarity randomRarity() {
-        std::array<std::pair<Rarity, int>, 5> table{{
-            {Rarity::Common,    55},
-            {Rarity::Uncommon,  25},
-            {Rarity::Rare,      12},
-            {Rarity::Epic,       6},
-            {Rarity::Legendary,  2}
-        }};
-        int total = 0; for (auto& p : table) total += p.second;
-        int roll = randInt(1, total);
-        int acc = 0;
-        for (auto& p : table) {
-            acc += p.second;
-            if (roll <= acc) return p.first;
+    std::uint64_t seed_;
+    RngStream rng_;
+    Snapshot<TemplateCatalog>         catalog_;
+    Snapshot<TemplateCatalog>::Reader reader_{catalog_};       // the factory's own cached view
+    std::mutex                        reloadMtx_;               // serialises catalog publishes
+    std::vector<LootDrop>             lootScratch_;             // reused by rollLoot
+
+    // drop weight per Rarity, Common first
+    static constexpr std::array<std::uint32_t, kRarityCount> kRarityWeights{55, 25, 12, 6, 2};
+    AliasTable rarityTable_;
+
+    static std::uint64_t freshSeed() {
+        std::random_device rd;
+        return (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
+    }
+
+    // builds the next catalog from a copy of the current one (merge) or
+    // from nothing, and publishes it
+    Result<void> publishTemplates(std::vector<ItemTemplate> templates, bool merge) {
+        std::lock_guard<std::mutex> lock(reloadMtx_);        // one writer at a time
+        auto next = merge ? std::make_shared<TemplateCatalog>(*catalog_.load())
+                          : std::make_shared<TemplateCatalog>();
+        next->byId.reserve(next->byId.size() + templates.size());
+        for (ItemTemplate& tmpl : templates) {
+            // stack size is a per‑type rule, not per template
+            bool stackable = tmpl.type == ItemType::Material || tmpl.type == ItemType::Consumable;
+            tmpl.maxStack = stackable ? 20 : 1;
+            const ItemTemplate& shared = ItemTemplates::intern(std::move(tmpl));
+            auto [it, inserted] = next->byId.try_emplace(shared.id, &shared);
+            if (inserted) {
+                next->dropOrder.push_back(&shared);
+            } else {                          // already held: swap in the new version
+                std::replace(next->dropOrder.begin(), next->dropOrder.end(), it->second, &shared);
+                it->second = &shared;
+            }
         }
-        return Rarity::Common;
+        // every template is equally likely; the alias table keeps the
+        // draw O(1) and is where per‑template drop weights would plug in
+        next->dropTable.build(std::vector<std::uint32_t>(next->dropOrder.size(), 1));
+
+        std::size_t count = next->byId.size();
+        catalog_.publish(std::move(next));
+        Log::info("Loaded " + std::to_string(count) + " item templates.");
+        return Result<void>::ok();
+    }
+
+    // -----------------------------------------------------------------
+    //  Generation – const, the catalog and all mutable state come in
+    //  from the caller (factory or Stream)
+    // -----------------------------------------------------------------
+    Result<Item> createWith(const TemplateCatalog& cat, ItemId id, int playerLevel, RngStream& rng) const {
+        auto it = cat.byId.find(id);
+        if (it == cat.byId.end())
+            return Result<Item>::err("Unknown item id '" + ItemIds::name(id) + "'");
+        return Result<Item>::ok(roll(*it->second, playerLevel, rng));
     }
 
-    std::string rarityPrefix(Rarity r) {
-        switch (r) {
-            case Rarity::Common:    return "";
-            case Rarity::Uncommon:  return "Uncommon";
-            case Rarity::Rare:      return "Rare";
-            case Rarity::Epic:      return "Epic";
-            case Rarity::Legendary: return "Legendary";
-            default:                return "";
+    Result<Item> createRandomWith(const TemplateCatalog& cat, int playerLevel, RngStream& rng) const {
+        if (cat.dropTable.empty())
+            return Result<Item>::err("No item templates loaded");
+        return Result<Item>::ok(roll(*cat.dropOrder[cat.dropTable.sample(rng)], playerLevel, rng));
+    }
+
+    Result<void> createBatchWith(const TemplateCatalog& cat, std::size_t n, int playerLevel,
+                                 std::vector<Item>& out, RngStream& rng) const {
+        if (cat.dropTable.empty())
+            return Result<void>::err("No item templates loaded");
+        out.reserve(out.size() + n);
+        for (std::size_t i = 0; i < n; ++i)
+            out.push_back(roll(*cat.dropOrder[cat.dropTable.sample(rng)], playerLevel, rng));
+        return Result<void>::ok();
+    }
+
+    Result<void> rollLootWith(const TemplateCatalog& cat, const LootTables& tables, LootTables::TableId table,
+                              int playerLevel, std::vector<Item>& out, RngStream& rng,
+                              std::vector<LootDrop>& scratch) const {
+        if (table >= tables.size())
+            return Result<void>::err("Unknown loot table");
+        scratch.clear();
+        tables.roll(table, rng, scratch);
+        for (const LootDrop& d : scratch)
+            if (!cat.byId.count(d.item))
+                return Result<void>::err("Loot table drops unknown item '" + ItemIds::name(d.item) + "'");
+
+        for (const LootDrop& d : scratch) {
+            const ItemTemplate& tmpl = *cat.byId.find(d.item)->second;
+            if (tmpl.maxStack > 1) {
+                out.push_back(roll(tmpl, playerLevel, rng));
+                out.back().stackSize = d.quantity;
+            } else {
+                for (int n = 0; n < d.quantity; ++n) out.push_back(roll(tmpl, playerLevel, rng));
+            }
         }
+        return Result<void>::ok();
+    }
+
+    // copy of the shared template with this drop's level, rarity and stats
+    Item roll(const ItemTemplate& tmpl, int playerLevel, RngStream& rng) const {
+        Item result(tmpl); // template is shared, only the rolls are per item
+        int jitter = static_cast<int>(rng() >> 30) - 1;        // top 2 bits: uniform in [-1, 2]
+        result.levelReq = static_cast<std::uint16_t>(std::max(1, playerLevel - 2 + jitter));
+
+        // apply rarity – higher rarity => higher stats
+        result.rarity = static_cast<Rarity>(rarityTable_.sample(rng));
+        float rarityMul = rarityMultiplier(result.rarity);
+        std::visit([&](auto& data) {
+            using T = std::decay_t<decltype(data)>;
+            if constexpr (std::is_same_v<T, WeaponData>) {
+                data.damage = static_cast<int>(data.damage * rarityMul);
+                if (data.durability > 0) data.durability = static_cast<int>(data.durability * rarityMul);
+            } else if constexpr (std::is_same_v<T, ArmorData>) {
+                data.defense = static_cast<int>(data.defense * rarityMul);
+            } else if constexpr (std::is_same_v<T, ConsumableData>) {
+                data.healAmount = static_cast<int>(data.healAmount * rarityMul);
+            }
+        }, result.data);
+        return result;
     }
 };
+
+/* -----------------------------------------------------------------
+   Per‑thread generation handle – owns its generator and scratch
+   ----------------------------------------------------------------- */
+class ItemFactory::Stream {
+public:
+    Stream(const ItemFactory& factory, RngStream rng)
+        : factory_(&factory), catalog_(factory.catalog_), rng_(rng) {}
+
+    Result<Item> create(const std::string& id, int playerLevel = 1) {
+        ItemId handle = ItemIds::find(id);
+        if (!handle) return Result<Item>::err("Unknown item id '" + id + "'");
+        return create(handle, playerLevel);
+    }
+    Result<Item> create(ItemId id, int playerLevel = 1) {
+        return factory_->createWith(catalog_.get(), id, playerLevel, rng_);
+    }
+    Result<Item> createRandomItem(int playerLevel = 1) {
+        return factory_->createRandomWith(catalog_.get(), playerLevel, rng_);
+    }
+    Result<void> createBatch(std::size_t n, int playerLevel, std::vector<Item>& out) {
+        return factory_->createBatchWith(catalog_.get(), n, playerLevel, out, rng_);
+    }
+    Result<void> rollLoot(const LootTables& tables, LootTables::TableId table, int playerLevel,
+                          std::vector<Item>& out) {
+        return factory_->rollLootWith(catalog_.get(), tables, table, playerLevel, out, rng_, scratch_);
+    }
+
+private:
+    const ItemFactory*                factory_;
+    Snapshot<TemplateCatalog>::Reader catalog_;     // picks up reloads between calls
+    RngStream                         rng_;
+    std::vector<LootDrop>             scratch_;
+};
+
+inline ItemFactory::Stream ItemFactory::stream(std::uint64_t streamId) const {
+    return Stream(*this, RngStream(seed_, streamId));
+}
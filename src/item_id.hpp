@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/*======================================================================
+ *  1) ItemId – interned 32‑bit handle for item ids
+ *     Strings only live at the JSON/UI boundary; everything in the core
+ *     (Item, Recipe, ItemFactory, Inventory) keys on the integer.
+ *====================================================================*/
+struct ItemId {
+    std::uint32_t value{0};                 // 0 = invalid / never interned
+
+    explicit operator bool() const noexcept { return value != 0; }
+    friend bool operator==(ItemId a, ItemId b) noexcept { return a.value == b.value; }
+    friend bool operator!=(ItemId a, ItemId b) noexcept { return a.value != b.value; }
+    friend bool operator< (ItemId a, ItemId b) noexcept { return a.value <  b.value; }
+};
+
+namespace std {
+    template <> struct hash<ItemId> {
+        std::size_t operator()(ItemId id) const noexcept { return id.value; }
+    };
+}
+
+namespace ItemIds {
+    inline std::shared_mutex mtx;
+    inline std::deque<std::string> names{""};                    // value → string (slot 0 unused)
+    inline std::unordered_map<std::string_view, ItemId> lookup;  // views into `names`
+
+    // returns the existing handle or assigns the next free one
+    inline ItemId intern(std::string_view s) {
+        {
+            std::shared_lock<std::shared_mutex> lock(mtx);
+            auto it = lookup.find(s);
+            if (it != lookup.end()) return it->second;
+        }
+        std::unique_lock<std::shared_mutex> lock(mtx);
+        auto it = lookup.find(s);
+        if (it != lookup.end()) return it->second;
+        ItemId id{static_cast<std::uint32_t>(names.size())};
+        names.emplace_back(s);
+        lookup.emplace(names.back(), id);
+        return id;
+    }
+
+    // lookup only – unknown strings map to the invalid id
+    inline ItemId find(std::string_view s) {
+        std::shared_lock<std::shared_mutex> lock(mtx);
+        auto it = lookup.find(s);
+        return it == lookup.end() ? ItemId{} : it->second;
+    }
+
+    inline const std::string& name(ItemId id) {
+        std::shared_lock<std::shared_mutex> lock(mtx);
+        return id.value < names.size() ? names[id.value] : names.front();
+    }
+}
@@ -0,0 +1,250 @@
+#pragma once
+
+#include "json.hpp"
+#include "item_id.hpp"
+#include "result.hpp"
+#include "logger.hpp"
+#include "alias_table.hpp"
+
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+/*======================================================================
+ *  12) LootTables – data‑driven, weighted drop tables (JSON)
+ *      [
+ *        { "id": "goblin", "rolls": 2,
+ *          "guaranteed": [ { "item": "coal", "min": 1, "max": 2 } ],
+ *          "entries": [
+ *            { "item": "iron_ore", "weight": 40, "min": 1, "max": 3 },
+ *            { "table": "gems",    "weight": 10 },
+ *            { "weight": 50 }                       // nothing
+ *          ] }
+ *      ]
+ *      Every guaranteed entry drops once, then `rolls` weighted picks
+ *      are made. A "table" entry rolls that sub‑table min..max times.
+ *      Loading compiles all tables into flat arrays (entries plus alias
+ *      buckets, table by table), so a roll is a few array reads.
+ *====================================================================*/
+struct LootDrop {
+    ItemId item;
+    int    quantity{1};
+};
+
+class LootTables {
+public:
+    using TableId = std::uint32_t;
+    static constexpr TableId npos = std::numeric_limits<TableId>::max();
+
+    Result<void> loadFromFile(const std::string& path) {
+        std::ifstream in(path);
+        if (!in) return Result<void>::err("Cannot open loot table file '" + path + "'");
+        std::string content((std::istreambuf_iterator<char>(in)), {});
+        json j;
+        try { j = json::parse(content); }
+        catch (const std::exception& e) { return Result<void>::err("JSON parse error: " + std::string(e.what())); }
+        return load(j);
+    }
+
+    // replaces every table; on error the previous tables are kept
+    Result<void> load(const json& j) {
+        try { return compile(j); }
+        catch (const std::exception& e) { return Result<void>::err("Bad loot table: " + std::string(e.what())); }
+    }
+
+    TableId find(const std::string& name) const {
+        auto it = names_.find(name);
+        return it == names_.end() ? npos : it->second;
+    }
+    std::size_t size() const { return tables_.size(); }
+
+    // appends the drops of one roll of `table` to `out`; reuse `out`
+    // across calls and nothing is allocated once it has grown
+    template <typename Rng>
+    void roll(TableId table, Rng& rng, std::vector<LootDrop>& out) const {
+        const Table& t = tables_[table];
+        for (std::uint32_t g = 0; g < t.guaranteedCount; ++g)
+            emit(guaranteed_[t.firstGuaranteed + g], rng, out);
+        if (t.entryCount == 0) return;
+        for (int r = 0; r < t.rolls; ++r) {
+            std::size_t k = AliasTable::sample(threshold_.data() + t.firstEntry, alias_.data() + t.firstEntry,
+                                               t.entryCount, rng);
+            emit(entries_[t.firstEntry + k], rng, out);
+        }
+    }
+
+private:
+    enum class Kind : std::uint8_t { Nothing, Item, Table };
+
+    struct Entry {
+        Kind          kind{Kind::Nothing};
+        std::uint32_t target{0};          // ItemId value or TableId
+        std::int32_t  minQty{1};
+        std::uint32_t qtySpan{1};         // max - min + 1
+    };
+
+    struct Table {
+        std::uint32_t firstEntry{0}, entryCount{0};
+        std::uint32_t firstGuaranteed{0}, guaranteedCount{0};
+        int           rolls{1};
+    };
+
+    std::vector<Table>         tables_;
+    std::vector<Entry>         entries_;      // weighted entries, table by table
+    std::vector<std::uint64_t> threshold_;    // alias buckets, parallel to entries_
+    std::vector<std::uint32_t> alias_;        // relative to the table's firstEntry
+    std::vector<Entry>         guaranteed_;
+    std::unordered_map<std::string, TableId> names_;
+
+    Result<void> compile(const json& j) {
+        if (!j.is_array())
+            return Result<void>::err("Loot table file must contain a JSON array");
+
+        // pass 1: names, so entries may refer to tables defined later
+        std::unordered_map<std::string, TableId> names;
+        std::vector<const json*> defs;
+        for (const auto& elem : j) {
+            if (!elem.is_object() || !elem.contains("id")) {
+                Log::warn("Skipping loot table without an id");
+                continue;
+            }
+            std::string name = elem.at("id").get<std::string>();
+            if (!names.emplace(name, static_cast<TableId>(defs.size())).second) {
+                Log::warn("Duplicate loot table '" + name + "' ignored");
+                continue;
+            }
+            defs.push_back(&elem);
+        }
+
+        // pass 2: compile into the flat arrays
+        LootTables next;
+        next.names_ = std::move(names);
+        std::vector<std::uint32_t> weights;
+        for (const json* def : defs) {
+            const std::string name = def->at("id").get<std::string>();
+            Table t;
+            t.rolls = std::max(0, def->value("rolls", 1));
+
+            t.firstGuaranteed = static_cast<std::uint32_t>(next.guaranteed_.size());
+            if (def->contains("guaranteed")) {
+                for (const auto& e : def->at("guaranteed"))
+                    next.guaranteed_.push_back(next.compileEntry(name, e));
+            }
+            t.guaranteedCount = static_cast<std::uint32_t>(next.guaranteed_.size()) - t.firstGuaranteed;
+
+            t.firstEntry = static_cast<std::uint32_t>(next.entries_.size());
+            weights.clear();
+            if (def->contains("entries")) {
+                for (const auto& e : def->at("entries")) {
+                    int w = e.value("weight", 1);
+                    if (w < 0) {
+                        Log::warn("Negative weight in loot table '" + name + "' treated as 0");
+                        w = 0;
+                    }
+                    weights.push_back(static_cast<std::uint32_t>(w));
+                    next.entries_.push_back(next.compileEntry(name, e));
+                }
+            }
+            t.entryCount = static_cast<std::uint32_t>(weights.size());
+            next.threshold_.resize(next.entries_.size());
+            next.alias_.resize(next.entries_.size());
+            if (!AliasTable::build(weights.data(), weights.size(),
+                                   next.threshold_.data() + t.firstEntry, next.alias_.data() + t.firstEntry))
+                t.entryCount = 0;                         // nothing to pick from; keep only guaranteed drops
+            next.tables_.push_back(t);
+        }
+
+        if (auto cyc = next.findCycle(); !cyc.empty())
+            return Result<void>::err("Loot table '" + cyc + "' includes itself");
+
+        *this = std::move(next);
+        Log::info("Loaded " + std::to_string(tables_.size()) + " loot tables.");
+        return Result<void>::ok();
+    }
+
+    Entry compileEntry(const std::string& table, const json& e) const {
+        Entry out;
+        int lo = e.value("min", 1);
+        int hi = e.value("max", lo);
+        if (lo < 0 || hi < lo) {
+            Log::warn("Bad quantity range in loot table '" + table + "', using 1");
+            lo = hi = 1;
+        }
+        out.minQty  = lo;
+        out.qtySpan = static_cast<std::uint32_t>(hi - lo) + 1;
+
+        if (e.contains("item")) {
+            out.kind   = Kind::Item;
+            out.target = ItemIds::intern(e.at("item").get<std::string>()).value;
+        } else if (e.contains("table")) {
+            std::string sub = e.at("table").get<std::string>();
+            TableId id = find(sub);
+            if (id == npos) {
+                Log::warn("Loot table '" + table + "' refers to unknown table '" + sub + "'");
+            } else {
+                out.kind   = Kind::Table;
+                out.target = id;
+            }
+        }
+        return out;
+    }
+
+    // name of a table that can reach itself, empty if none
+    std::string findCycle() const {
+        enum : std::uint8_t { White, Grey, Black };
+        std::vector<std::uint8_t> colour(tables_.size(), White);
+        auto children = [this](TableId id, auto&& visit) {
+            const Table& t = tables_[id];
+            for (std::uint32_t i = 0; i < t.guaranteedCount; ++i)
+                if (guaranteed_[t.firstGuaranteed + i].kind == Kind::Table && visit(guaranteed_[t.firstGuaranteed + i].target))
+                    return true;
+            for (std::uint32_t i = 0; i < t.entryCount; ++i)
+                if (entries_[t.firstEntry + i].kind == Kind::Table && visit(entries_[t.firstEntry + i].target))
+                    return true;
+            return false;
+        };
+        TableId culprit = npos;
+        auto dfs = [&](TableId id, auto&& self) -> bool {
+            colour[id] = Grey;
+            bool cyclic = children(id, [&](TableId c) {
+                if (colour[c] == Grey) { culprit = c; return true; }
+                return colour[c] == White && self(c, self);
+            });
+            colour[id] = Black;
+            return cyclic;
+        };
+        for (TableId id = 0; id < tables_.size(); ++id)
+            if (colour[id] == White && dfs(id, dfs)) break;
+        if (culprit == npos) return {};
+        for (const auto& [name, id] : names_)
+            if (id == culprit) return name;
+        return {};
+    }
+
+    template <typename Rng>
+    int quantity(const Entry& e, Rng& rng) const {
+        if (e.qtySpan == 1) return e.minQty;
+        std::uint64_t r = static_cast<std::uint32_t>(rng() - Rng::min());
+        return e.minQty + static_cast<int>((r * e.qtySpan) >> 32);
+    }
+
+    template <typename Rng>
+    void emit(const Entry& e, Rng& rng, std::vector<LootDrop>& out) const {
+        switch (e.kind) {
+            case Kind::Item:
+                if (int n = quantity(e, rng); n > 0) out.push_back({ItemId{e.target}, n});
+                break;
+            case Kind::Table:
+                for (int n = quantity(e, rng); n > 0; --n) roll(e.target, rng, out);
+                break;
+            case Kind::Nothing:
+                break;
+        }
+    }
+};
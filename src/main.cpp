@@ -1,28 +1,60 @@
 #include "inventory.hpp"
 #include "item_factory.hpp"
 #include "crafting.hpp"
+#include "catalog_file.hpp"
+#include "craft_planner.hpp"
+#include "loot_table.hpp"
+#include "file_watch.hpp"
 #include "logger.hpp"
 
 #include <iostream>
 #include <fstream>
 #include <limits>
+#include <sstream>
+#include <algorithm>
 #include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    // derleme adımı: JSON kataloglarını ikili dosyaya çevir ve çık
+    if (argc > 1 && std::string(argv[1]) == "--compile-catalog") {
+        std::string out = argc > 2 ? argv[2] : "catalog.bin";
+        if (auto r = CatalogFile::compile("templates.json", "recipes.json", out); !r) {
+            Log::error("Catalog compile failed: " + r.error());
+            return 1;
+        }
+        return 0;
+    }
 
-int main() {
     Log::setFile("game.log");               // isteğe bağlı dosya logu
     ItemFactory   factory;
     CraftingSystem crafting;
+    CraftPlanner  planner(crafting);         // çok seviyeli üretim planı
+    LootTables    loot;
 
-    if (auto r = factory.loadTemplates("templates.json"); !r) {
-        Log::error("Cannot continue without item templates: " + r.error());
-        return 1;
-    }
-    if (auto r = crafting.loadFromFile("recipes.json"); !r) {
-        Log::error("Cannot continue without recipes: " + r.error());
+    // güncel catalog.bin varsa JSON hiç ayrıştırılmaz
+    if (auto r = CatalogFile::load("catalog.bin", "templates.json", "recipes.json", factory, crafting); !r) {
+        Log::error("Cannot continue without item templates and recipes: " + r.error());
         return 1;
     }
+    if (auto r = loot.loadFromFile("loot_tables.json"); !r)   // yoksa tamamen rastgele ganimet
+        Log::warn("Loot tables not loaded, using random items: " + r.error());
+    Log::info("Loot seed: " + std::to_string(factory.seed()));   // hata raporları için
+
+    FileWatcher watcher;                     // veri dosyaları değişince yeniden yükle
+    watcher.watch("templates.json", [&](const std::string& path) {
+        if (auto r = factory.loadTemplates(path); !r) Log::warn("Template reload failed: " + r.error());
+    });
+    watcher.watch("recipes.json", [&](const std::string& path) {
+        if (auto r = crafting.loadFromFile(path); !r) Log::warn("Recipe reload failed: " + r.error());
+    });
+    watcher.start();
 
     Inventory inv(30, 300);                  // 30 slot, 300 ağırlık limiti
+    std::string screen;                      // her çizimde yeniden kullanılan tampon
+    std::vector<Item> drops;                 // ganimet tamponu
+    inv.setAutoCompact(true);                // slot dolunca yarım yığınları birleştir
+    inv.trackCraftable(crafting);            // "şimdi üretilebilir" listesi artımlı tutulur
     int playerLevel = 5;
 
     while (true) {
@@ -35,6 +67,7 @@ int main() {
         std::cout << "6) Unequip slot\n";
         std::cout << "7) Save game\n";
         std::cout << "8) Load game\n";
+        std::cout << "9) Sort inventory\n";
         std::cout << "0) Exit\n";
         std::cout << "Choice: ";
         int choice;
@@ -49,39 +82,75 @@ int main() {
                 std::cout << "\n--- Inventory (slots used: " << inv.usedSlots()
                           << " / 30, weight: " << inv.totalWeight()
                           << " / 300) ---\n";
-                for (size_t i = 0; i < items.size(); ++i) {
-                    std::cout << i + 1 << ") " << items[i].getDescription() << "\n";
-                }
+                screen.clear();
+                appendDescriptions(screen, items);
+                std::cout << screen;
                 break;
             }
             case 2: {   // ekipmanı göster
                 const auto& equip = inv.getEquipment();
                 std::cout << "\n--- Equipment ------------------------------------------------\n";
-                for (const auto& [slot, ptr] : equip) {
-                    std::cout << toString(slot) << ": ";
-                    if (ptr) std::cout << ptr->getDescription() << "\n";
-                    else     std::cout << "(empty)\n";
+                for (size_t i = 0; i < equip.size(); ++i) {
+                    std::cout << toString(static_cast<EquipSlot>(i)) << ": ";
+                    if (equip[i]) std::cout << equip[i]->getDescription() << "\n";
+                    else          std::cout << "(empty)\n";
                 }
+                const auto& stats = inv.equipmentStats();
+                std::cout << "Total DMG " << stats.damage << ", DEF " << stats.defense
+                          << ", weight " << stats.weight << "\n";
                 break;
             }
-            case 3: {   // rastgele ganimet ekle
-                auto res = factory.createRandomItem(playerLevel);
-                if (!res) {
-                    std::cout << "Factory error: " << res.error() << "\n";
-                    break;
+            case 3: {   // rastgele ganimet ekle ("chest" tablosu varsa ondan)
+                drops.clear();
+                if (auto chest = loot.find("chest"); chest != LootTables::npos) {
+                    if (auto r = factory.rollLoot(loot, chest, playerLevel, drops); !r) {
+                        std::cout << "Factory error: " << r.error() << "\n";
+                        break;
+                    }
+                } else {
+                    auto res = factory.createRandomItem(playerLevel);
+                    if (!res) {
+                        std::cout << "Factory error: " << res.error() << "\n";
+                        break;
+                    }
+                    drops.push_back(res.value());
+                }
+                if (drops.empty()) std::cout << "Nothing found.\n";
+                for (const Item& item : drops) {
+                    auto addRes = inv.addItem(item);
+                    if (!addRes) std::cout << "Cannot add loot: " << addRes.error() << "\n";
+                    else           std::cout << "You found: " << item.getDescription() << "\n";
                 }
-                auto addRes = inv.addItem(res.value());
-                if (!addRes) std::cout << "Cannot add loot: " << addRes.error() << "\n";
-                else           std::cout << "You found: " << res.value().getDescription() << "\n";
                 break;
             }
             case 4: {   // öğe üret
-                std::cout << "Enter recipe result id (e.g. iron_sword): ";
-                std::string rid;
-                std::getline(std::cin, rid);
-                auto craftRes = inv.craft(rid, factory, crafting, playerLevel);
-                if (!craftRes) std::cout << "Craft failed: " << craftRes.error() << "\n";
-                else           std::cout << "Craft succeeded!\n";
+                std::cout << "Craftable now:";
+                for (ItemId id : inv.craftable()) std::cout << ' ' << ItemIds::name(id);
+                std::cout << (inv.craftable().empty() ? " (nothing)\n" : "\n");
+                std::cout << "Enter recipe result id and count (e.g. iron_ingot 10): ";
+                std::string line, rid;
+                int times = 1;                       // adet verilmezse tek üretim
+                std::getline(std::cin, line);
+                std::istringstream(line) >> rid >> times;
+                auto craftRes = inv.craft(rid, std::max(1, times), factory, crafting, playerLevel);
+                if (craftRes) {
+                    std::cout << "Crafted " << craftRes.value() << " time(s).\n";
+                    break;
+                }
+                std::cout << "Craft failed: " << craftRes.error() << "\n";
+                // ara ürünler dahil tam planı ve eksik hammaddeleri göster
+                if (auto plan = planner.plan(inv, rid); plan && !plan.value().lines.empty()) {
+                    std::cout << "Full plan:\n";
+                    for (const PlanLine& line : plan.value().lines) {
+                        std::cout << "  " << ItemIds::name(line.item) << ": need " << line.needed
+                                  << ", have " << line.fromStock;
+                        if (line.crafts)  std::cout << ", craft x" << line.crafts;
+                        if (line.missing) std::cout << ", MISSING " << line.missing;
+                        std::cout << "\n";
+                    }
+                    if (auto most = planner.maxCraftable(inv, rid); most)
+                        std::cout << "Craftable from raw materials: " << most.value() << "\n";
+                }
                 break;
             }
             case 5: {   // ekipana tak
@@ -97,13 +166,7 @@ int main() {
                 std::cout << "Enter slot name (Head, Chest, Legs, Weapon, Shield, Accessory): ";
                 std::string slotStr;
                 std::getline(std::cin, slotStr);
-                EquipSlot slot = EquipSlot::None;
-                if (slotStr == "Head")       slot = EquipSlot::Head;
-                else if (slotStr == "Chest") slot = EquipSlot::Chest;
-                else if (slotStr == "Legs")  slot = EquipSlot::Legs;
-                else if (slotStr == "Weapon")slot = EquipSlot::Weapon;
-                else if (slotStr == "Shield")slot = EquipSlot::Shield;
-                else if (slotStr == "Accessory") slot = EquipSlot::Accessory;
+                EquipSlot slot = stringToEquipSlot(slotStr);
                 if (slot == EquipSlot::None) {
                     std::cout << "Invalid slot.\n";
                     break;
@@ -135,6 +198,11 @@ int main() {
                 else          std::cout << "Game loaded.\n";
                 break;
             }
+            case 9: {   // birleştir + sırala
+                std::size_t freed = inv.compact(true);
+                std::cout << "Inventory sorted, " << freed << " slot(s) freed.\n";
+                break;
+            }
             default:
                 std::cout << "Unknown option.\n";
         }
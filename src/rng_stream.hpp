@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+/*======================================================================
+ *  13) RngStream – seedable, splittable 32‑bit generator (PCG32)
+ *      RngStream(masterSeed, streamId): the seed picks the starting
+ *      state, the stream id picks the increment, both run through
+ *      SplitMix64 first. Different ids are independent sequences, so
+ *      each worker thread owns one and never shares or locks it; the
+ *      same (seed, id) pair replays the same numbers on every platform.
+ *====================================================================*/
+inline std::uint64_t splitMix64(std::uint64_t& x) {
+    std::uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+class RngStream {
+public:
+    using result_type = std::uint32_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return 0xFFFFFFFFu; }
+
+    explicit RngStream(std::uint64_t masterSeed = 0, std::uint64_t streamId = 0) {
+        std::uint64_t s = masterSeed, id = streamId;
+        std::uint64_t start = splitMix64(s);
+        inc_   = (splitMix64(id) << 1) | 1u;                 // must be odd
+        state_ = 0;
+        (*this)();
+        state_ += start;
+        (*this)();
+    }
+
+    result_type operator()() {
+        std::uint64_t old = state_;
+        state_ = old * 6364136223846793005ull + inc_;
+        auto xorshifted = static_cast<std::uint32_t>(((old >> 18) ^ old) >> 27);
+        auto rot        = static_cast<std::uint32_t>(old >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+
+private:
+    std::uint64_t state_{0};
+    std::uint64_t inc_{1};
+};
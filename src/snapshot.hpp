@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+/*======================================================================
+ *  14) Snapshot<T> – RCU‑style publication of immutable data
+ *      Writers build a complete new T off to the side and publish() it
+ *      with one atomic pointer swap; readers keep using whatever
+ *      snapshot they loaded. Reclamation is the shared_ptr count: an
+ *      old snapshot dies when its last reader lets go.
+ *      The pointer swap itself is not lock‑free: std::atomic<shared_ptr>
+ *      (C++20) guards the pointer with a lock bit, and C++17's free
+ *      atomic_load/atomic_store on a shared_ptr take one of libstdc++'s
+ *      global mutexes. Hot paths therefore go through a Reader, which
+ *      caches the current snapshot per thread and calls load() only
+ *      when the version moved – the steady‑state read is a single
+ *      lock‑free atomic load with no reference‑count traffic.
+ *====================================================================*/
+template <typename T>
+class Snapshot {
+public:
+    using Ptr = std::shared_ptr<const T>;
+
+    Snapshot() : ptr_(std::make_shared<const T>()) {}
+
+    // takes a lock (see above) – keep it off hot paths, use a Reader
+#if defined(__cpp_lib_atomic_shared_ptr)
+    Ptr load() const { return ptr_.load(std::memory_order_acquire); }
+
+    void publish(Ptr next) {
+        ptr_.store(std::move(next), std::memory_order_release);
+        version_.fetch_add(1, std::memory_order_release);
+    }
+#else
+    Ptr load() const { return std::atomic_load_explicit(&ptr_, std::memory_order_acquire); }
+
+    void publish(Ptr next) {
+        std::atomic_store_explicit(&ptr_, std::move(next), std::memory_order_release);
+        version_.fetch_add(1, std::memory_order_release);
+    }
+#endif
+
+    std::uint64_t version() const { return version_.load(std::memory_order_acquire); }
+
+    class Reader {
+    public:
+        explicit Reader(const Snapshot& source) : source_(&source) {}
+
+        const T& get() {
+            std::uint64_t v = source_->version();
+            if (v != version_ || !ptr_) {
+                ptr_     = source_->load();
+                version_ = v;
+            }
+            return *ptr_;
+        }
+
+    private:
+        const Snapshot* source_;
+        Ptr             ptr_;
+        std::uint64_t   version_{0};
+    };
+
+private:
+#if defined(__cpp_lib_atomic_shared_ptr)
+    std::atomic<Ptr>           ptr_;
+#else
+    Ptr                        ptr_;
+#endif
+    std::atomic<std::uint64_t> version_{0};
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "inventory_registry.hpp"
+#include "inventory.hpp"
+#include "result.hpp"
+
+#include <algorithm>
+#include <vector>
+#include <mutex>
+#include <string>
+#include <utility>
+
+/*======================================================================
+ *  9) TradeEngine – atomic transfers between inventories
+ *     Both inventories are locked in ascending player id order (the one
+ *     global lock order, so concurrent trades can never deadlock), both
+ *     sides are validated with canApplyBatch, and only then are both
+ *     batches committed.
+ *====================================================================*/
+struct TradeLeg {
+    ItemId     id;
+    int        quantity{1};
+    SlotHandle slot{};          // a specific stack of `id`; default = any
+};
+
+class TradeEngine {
+public:
+    using Key = InventoryRegistry::Key;
+
+    explicit TradeEngine(InventoryRegistry& registry) : registry_(registry) {}
+
+    // one‑way move, e.g. bag → bank
+    Result<void> transfer(Key from, Key to, ItemId id, int quantity) {
+        return trade(from, {TradeLeg{id, quantity}}, to, {});
+    }
+
+    // `a` hands over aGives and receives bGives; all or nothing
+    Result<void> trade(Key a, const std::vector<TradeLeg>& aGives,
+                       Key b, const std::vector<TradeLeg>& bGives) {
+        if (a == b) return Result<void>::err("cannot trade with yourself");
+
+        auto ha = registry_.acquire(a);
+        auto hb = registry_.acquire(b);
+        if (!ha) return Result<void>::err("unknown player " + std::to_string(a));
+        if (!hb) return Result<void>::err("unknown player " + std::to_string(b));
+
+        Entry& first  = a < b ? *ha : *hb;
+        Entry& second = a < b ? *hb : *ha;
+        std::lock_guard<std::mutex> lockFirst(first.mtx);
+        std::lock_guard<std::mutex> lockSecond(second.mtx);
+
+        std::vector<InventoryOp> opsA, opsB;
+        if (auto r = buildLegs(ha->inv, aGives, opsA, opsB); !r)
+            return Result<void>::err("player " + std::to_string(a) + ": " + r.error());
+        if (auto r = buildLegs(hb->inv, bGives, opsB, opsA); !r)
+            return Result<void>::err("player " + std::to_string(b) + ": " + r.error());
+
+        if (auto r = ha->inv.canApplyBatch(opsA); !r)
+            return Result<void>::err("player " + std::to_string(a) + ": " + r.error());
+        if (auto r = hb->inv.canApplyBatch(opsB); !r)
+            return Result<void>::err("player " + std::to_string(b) + ": " + r.error());
+
+        // both plans were validated under the locks, so neither can fail now
+        ha->inv.applyBatch(opsA);
+        hb->inv.applyBatch(opsB);
+        return Result<void>::ok();
+    }
+
+private:
+    using Entry = InventoryRegistry::Entry;
+
+    InventoryRegistry& registry_;
+
+    // every unit handed over is taken from a concrete stack, and the
+    // receiver gets a copy of exactly that stack (rarity, rolled stats),
+    // so non‑stackable items of one id are never swapped for each other
+    static Result<void> buildLegs(const Inventory& giver, const std::vector<TradeLeg>& legs,
+                                  std::vector<InventoryOp>& giverOps,
+                                  std::vector<InventoryOp>& receiverOps) {
+        std::vector<std::pair<SlotHandle, int>> claimed;    // units already taken per stack
+        std::vector<SlotHandle> stacks;
+        for (const auto& leg : legs) {
+            if (leg.quantity <= 0) continue;
+            if (leg.slot.index != SlotHandle{}.index) stacks.assign(1, leg.slot);
+            else                                     giver.stacksOf(leg.id, stacks);
+
+            int remaining = leg.quantity;
+            for (SlotHandle h : stacks) {
+                const Item* src = giver.get(h);
+                if (!src || src->id() != leg.id)
+                    return Result<void>::err("stale slot handle for '" + ItemIds::name(leg.id) + "'");
+                auto c = std::find_if(claimed.begin(), claimed.end(),
+                                      [h](const auto& e) { return e.first == h; });
+                if (c == claimed.end()) c = claimed.insert(claimed.end(), {h, 0});
+                int take = std::min(src->stackSize - c->second, remaining);
+                if (take <= 0) continue;
+                c->second += take;
+                remaining -= take;
+
+                Item moved = *src;
+                moved.stackSize = take;
+                giverOps.push_back(InventoryOp::removeAt(h, take));
+                receiverOps.push_back(InventoryOp::add(std::move(moved)));
+                if (remaining == 0) break;
+            }
+            if (remaining > 0)
+                return Result<void>::err("not enough '" + ItemIds::name(leg.id) + "' in inventory");
+        }
+        return Result<void>::ok();
+    }
+};
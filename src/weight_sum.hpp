@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/*======================================================================
+ *  10) Bulk weight sums – Σ unitWeight × stackSize over packed columns
+ *      Empty rows carry stackSize 0, so a whole run of slots is one
+ *      branch‑free dot product. Products are widened to 64 bits, so
+ *      sums over millions of rows cannot overflow.
+ *      The AVX2 path is compiled in with -DRPG_ENABLE_AVX2=ON (or any
+ *      -mavx2 / /arch:AVX2 build); otherwise the scalar loop is used.
+ *====================================================================*/
+namespace WeightSum {
+
+inline std::int64_t scalar(const std::int32_t* unit, const std::int32_t* count, std::size_t n) {
+    std::int64_t sum = 0;
+    for (std::size_t i = 0; i < n; ++i)
+        sum += static_cast<std::int64_t>(unit[i]) * count[i];
+    return sum;
+}
+
+#if defined(__AVX2__)
+inline std::int64_t avx2(const std::int32_t* unit, const std::int32_t* count, std::size_t n) {
+    __m256i even = _mm256_setzero_si256();
+    __m256i odd  = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i u = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(unit + i));
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(count + i));
+        // mul_epi32 multiplies the low (even) lanes into 64‑bit products;
+        // shifting each 64‑bit lane down brings the odd lanes into place
+        even = _mm256_add_epi64(even, _mm256_mul_epi32(u, c));
+        odd  = _mm256_add_epi64(odd,  _mm256_mul_epi32(_mm256_srli_epi64(u, 32),
+                                                       _mm256_srli_epi64(c, 32)));
+    }
+    alignas(32) std::int64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), _mm256_add_epi64(even, odd));
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + scalar(unit + i, count + i, n - i);
+}
+#endif
+
+// best kernel this build supports
+inline std::int64_t dot(const std::int32_t* unit, const std::int32_t* count, std::size_t n) {
+#if defined(__AVX2__)
+    return avx2(unit, count, n);
+#else
+    return scalar(unit, count, n);
+#endif
+}
+
+} // namespace WeightSum